@@ -0,0 +1,146 @@
+#ifndef __BUFFER_POOL_H__
+#define __BUFFER_POOL_H__
+
+#include "types.h"
+
+namespace json_context {
+
+    struct buffer_pool_options {
+        size_t max_buffers = 16;            // free buffers kept around, extra ones are freed
+        size_t max_capacity = 1 << 20;      // buffers grown past this are freed instead of kept
+        size_t trim_interval = 1024;        // releases between two trims
+        size_t trim_factor = 4;             // trims free buffers this many times bigger than the largest recent output
+    };
+
+    class buffer_pool;
+
+    // Owns a buffer borrowed from a buffer_pool and gives it back when destroyed.
+    // Must be destroyed on the thread owning the pool.
+    class pooled_buffer {
+    private:
+        buffer_pool *m_pool = nullptr;
+        std::string m_buffer;
+
+    public:
+        pooled_buffer() = default;
+
+        pooled_buffer(buffer_pool *pool, std::string &&buffer)
+            : m_pool{pool}
+            , m_buffer{std::move(buffer)} {}
+
+        pooled_buffer(pooled_buffer &&other) noexcept
+            : m_pool{std::exchange(other.m_pool, nullptr)}
+            , m_buffer{std::move(other.m_buffer)} {}
+
+        pooled_buffer &operator = (pooled_buffer &&other) noexcept {
+            if (this != &other) {
+                reset();
+                m_pool = std::exchange(other.m_pool, nullptr);
+                m_buffer = std::move(other.m_buffer);
+            }
+            return *this;
+        }
+
+        ~pooled_buffer() {
+            reset();
+        }
+
+        std::string &str() { return m_buffer; }
+        const std::string &str() const { return m_buffer; }
+
+        std::string_view view() const { return m_buffer; }
+        operator std::string_view() const { return m_buffer; }
+
+        const char *data() const { return m_buffer.data(); }
+        size_t size() const { return m_buffer.size(); }
+
+        // Takes ownership of the buffer, which won't go back to the pool.
+        std::string release() {
+            m_pool = nullptr;
+            return std::move(m_buffer);
+        }
+
+        void reset();
+    };
+
+    class buffer_pool {
+    private:
+        buffer_pool_options m_options;
+        std::vector<std::string> m_free;
+
+        size_t m_high_water = 0;
+        size_t m_releases = 0;
+
+    public:
+        explicit buffer_pool(buffer_pool_options options = {})
+            : m_options{options} {}
+
+        buffer_pool(const buffer_pool &) = delete;
+        buffer_pool &operator = (const buffer_pool &) = delete;
+
+        static buffer_pool &local() {
+            static thread_local buffer_pool pool;
+            return pool;
+        }
+
+        pooled_buffer acquire() {
+            std::string buffer;
+            if (!m_free.empty()) {
+                buffer = std::move(m_free.back());
+                m_free.pop_back();
+            }
+            return pooled_buffer{this, std::move(buffer)};
+        }
+
+        void recycle(std::string &&buffer) {
+            m_high_water = std::max(m_high_water, buffer.size());
+            if (buffer.capacity() <= m_options.max_capacity && m_free.size() < m_options.max_buffers) {
+                buffer.clear();
+                m_free.push_back(std::move(buffer));
+            }
+            if (++m_releases >= m_options.trim_interval) {
+                trim();
+            }
+        }
+
+        // Shrinks the free buffers that are much bigger than the largest output seen since
+        // the last trim, so that a single huge payload doesn't pin its memory forever.
+        // Buffers within trim_factor of it are left alone, as outputs of varying size would
+        // otherwise have to grow them again after every trim.
+        void trim() {
+            for (auto &buffer : m_free) {
+                if (buffer.capacity() / m_options.trim_factor > m_high_water) {
+                    // swap, moving a short string in would keep the old allocation
+                    std::string shrunk;
+                    shrunk.reserve(m_high_water);
+                    buffer.swap(shrunk);
+                }
+            }
+            m_high_water = 0;
+            m_releases = 0;
+        }
+
+        size_t free_buffers() const {
+            return m_free.size();
+        }
+
+        // Bytes reserved by the free buffers.
+        size_t free_capacity() const {
+            size_t total = 0;
+            for (const auto &buffer : m_free) {
+                total += buffer.capacity();
+            }
+            return total;
+        }
+    };
+
+    inline void pooled_buffer::reset() {
+        if (m_pool) {
+            std::exchange(m_pool, nullptr)->recycle(std::move(m_buffer));
+        }
+        m_buffer = {};
+    }
+
+}
+
+#endif
@@ -0,0 +1,426 @@
+#ifndef __COMPRESSED_BUFFER_H__
+#define __COMPRESSED_BUFFER_H__
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <memory>
+#include <span>
+
+#include "types.h"
+
+#if __has_include(<unistd.h>)
+#include <unistd.h>
+#endif
+
+#ifdef JSON_CONTEXT_HAS_ZLIB
+#include <zlib.h>
+#endif
+
+#ifdef JSON_CONTEXT_HAS_ZSTD
+#include <zstd.h>
+#endif
+
+namespace json_context::compression {
+
+    // Receives compressed blocks as they are produced.
+    template<typename T>
+    concept sink = std::invocable<T &, std::string_view>;
+
+    // Fills the given span with compressed bytes, returning how many were written, 0 at end of input.
+    template<typename T>
+    concept source = requires (T &v, std::span<char> data) {
+        { v(data) } -> std::convertible_to<size_t>;
+    };
+
+    struct ostream_sink {
+        std::ostream &stream;
+
+        void operator()(std::string_view data) {
+            if (!stream.write(data.data(), data.size())) {
+                throw compression_error{"Error writing to stream"};
+            }
+        }
+    };
+
+    struct istream_source {
+        std::istream &stream;
+
+        size_t operator()(std::span<char> data) {
+            stream.read(data.data(), data.size());
+            if (stream.bad()) {
+                throw compression_error{"Error reading from stream"};
+            }
+            return stream.gcount();
+        }
+    };
+
+#if __has_include(<unistd.h>)
+    struct fd_sink {
+        int fd;
+
+        void operator()(std::string_view data) {
+            while (!data.empty()) {
+                auto written = ::write(fd, data.data(), data.size());
+                if (written < 0) {
+                    if (errno == EINTR) continue;
+                    throw compression_error{"Error writing to file descriptor"};
+                }
+                data.remove_prefix(written);
+            }
+        }
+    };
+
+    struct fd_source {
+        int fd;
+
+        size_t operator()(std::span<char> data) {
+            while (true) {
+                auto result = ::read(fd, data.data(), data.size());
+                if (result >= 0) return result;
+                if (errno != EINTR) {
+                    throw compression_error{"Error reading from file descriptor"};
+                }
+            }
+        }
+    };
+#endif
+
+    static constexpr size_t default_block_size = 64 * 1024;
+
+#ifdef JSON_CONTEXT_HAS_ZLIB
+
+    enum class deflate_format {
+        zlib,
+        gzip,
+        raw
+    };
+
+    namespace detail {
+        constexpr int window_bits(deflate_format format) {
+            switch (format) {
+            case deflate_format::gzip: return MAX_WBITS + 16;
+            case deflate_format::raw:  return -MAX_WBITS;
+            default:                   return MAX_WBITS;
+            }
+        }
+    }
+
+    // An output_buffer for json_writer: appends are gathered into blocks of BlockSize bytes,
+    // each block is deflated as soon as it is full and the output handed to the sink,
+    // so memory use stays constant however large the document is. Call finish() at the end.
+    template<sink Sink, size_t BlockSize = default_block_size>
+    class deflate_buffer {
+    private:
+        Sink m_sink;
+        z_stream m_stream{};
+
+        std::unique_ptr<char[]> m_input = std::make_unique_for_overwrite<char[]>(BlockSize);
+        std::unique_ptr<char[]> m_output = std::make_unique_for_overwrite<char[]>(BlockSize);
+        size_t m_input_size = 0;
+        size_t m_total_size = 0;
+
+        bool m_finished = false;
+
+        void compress(int flush) {
+            m_stream.next_in = reinterpret_cast<Bytef *>(m_input.get());
+            m_stream.avail_in = static_cast<uInt>(m_input_size);
+            do {
+                m_stream.next_out = reinterpret_cast<Bytef *>(m_output.get());
+                m_stream.avail_out = static_cast<uInt>(BlockSize);
+                int result = ::deflate(&m_stream, flush);
+                if (result == Z_STREAM_ERROR) {
+                    throw compression_error{"Error in deflate"};
+                }
+                size_t produced = BlockSize - m_stream.avail_out;
+                if (produced != 0) {
+                    m_sink(std::string_view(m_output.get(), produced));
+                }
+            } while (m_stream.avail_out == 0);
+            m_input_size = 0;
+        }
+
+    public:
+        explicit deflate_buffer(Sink sink, deflate_format format = deflate_format::gzip, int level = Z_DEFAULT_COMPRESSION)
+            : m_sink{std::move(sink)}
+        {
+            if (deflateInit2(&m_stream, level, Z_DEFLATED, detail::window_bits(format), 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+                throw compression_error{"Error initializing deflate"};
+            }
+        }
+
+        deflate_buffer(const deflate_buffer &) = delete;
+        deflate_buffer &operator = (const deflate_buffer &) = delete;
+
+        ~deflate_buffer() {
+            deflateEnd(&m_stream);
+        }
+
+        void append(std::string_view data) {
+            if (m_finished) {
+                throw compression_error{"Append after finish"};
+            }
+            m_total_size += data.size();
+            while (!data.empty()) {
+                size_t count = std::min(data.size(), BlockSize - m_input_size);
+                std::memcpy(m_input.get() + m_input_size, data.data(), count);
+                m_input_size += count;
+                data.remove_prefix(count);
+                if (m_input_size == BlockSize) {
+                    compress(Z_NO_FLUSH);
+                }
+            }
+        }
+
+        // Uncompressed bytes appended so far.
+        size_t size() const {
+            return m_total_size;
+        }
+
+        // Pushes everything appended so far to the sink, so that a reader can decode it.
+        void flush() {
+            compress(Z_SYNC_FLUSH);
+        }
+
+        void finish() {
+            if (!m_finished) {
+                compress(Z_FINISH);
+                m_finished = true;
+            }
+        }
+    };
+
+    template<source Source, size_t BlockSize = default_block_size>
+    class inflate_source {
+    private:
+        Source m_source;
+        z_stream m_stream{};
+
+        std::unique_ptr<char[]> m_input = std::make_unique_for_overwrite<char[]>(BlockSize);
+        std::unique_ptr<char[]> m_output = std::make_unique_for_overwrite<char[]>(BlockSize);
+
+        bool m_finished = false;
+        bool m_output_full = false;
+
+    public:
+        // With deflate_format::gzip both gzip and zlib streams are accepted.
+        explicit inflate_source(Source source, deflate_format format = deflate_format::gzip)
+            : m_source{std::move(source)}
+        {
+            int window_bits = format == deflate_format::gzip ? MAX_WBITS + 32 : detail::window_bits(format);
+            if (inflateInit2(&m_stream, window_bits) != Z_OK) {
+                throw compression_error{"Error initializing inflate"};
+            }
+        }
+
+        inflate_source(const inflate_source &) = delete;
+        inflate_source &operator = (const inflate_source &) = delete;
+
+        ~inflate_source() {
+            inflateEnd(&m_stream);
+        }
+
+        // Returns the next chunk of decompressed data, valid until the next call; empty at the end.
+        std::string_view next() {
+            while (!m_finished) {
+                // a full output block may leave more output pending inside zlib without needing input
+                if (m_stream.avail_in == 0 && !m_output_full) {
+                    size_t count = m_source(std::span<char>(m_input.get(), BlockSize));
+                    if (count == 0) {
+                        throw compression_error{"Unexpected end of compressed stream"};
+                    }
+                    m_stream.next_in = reinterpret_cast<Bytef *>(m_input.get());
+                    m_stream.avail_in = static_cast<uInt>(count);
+                }
+
+                m_stream.next_out = reinterpret_cast<Bytef *>(m_output.get());
+                m_stream.avail_out = static_cast<uInt>(BlockSize);
+                int result = ::inflate(&m_stream, Z_NO_FLUSH);
+                m_output_full = m_stream.avail_out == 0;
+                if (result == Z_STREAM_END) {
+                    m_finished = true;
+                } else if (result != Z_OK && result != Z_BUF_ERROR) {
+                    throw compression_error{"Error in inflate"};
+                }
+
+                size_t produced = BlockSize - m_stream.avail_out;
+                if (produced != 0) {
+                    return std::string_view(m_output.get(), produced);
+                }
+            }
+            return {};
+        }
+
+        void read_all(std::string &out) {
+            for (auto chunk = next(); !chunk.empty(); chunk = next()) {
+                out.append(chunk);
+            }
+        }
+    };
+
+#endif
+
+#ifdef JSON_CONTEXT_HAS_ZSTD
+
+    template<sink Sink>
+    class zstd_buffer {
+    private:
+        Sink m_sink;
+        ZSTD_CCtx *m_context;
+
+        size_t m_block_size = ZSTD_CStreamInSize();
+        size_t m_output_size = ZSTD_CStreamOutSize();
+
+        std::unique_ptr<char[]> m_input = std::make_unique_for_overwrite<char[]>(m_block_size);
+        std::unique_ptr<char[]> m_output = std::make_unique_for_overwrite<char[]>(m_output_size);
+        size_t m_input_size = 0;
+        size_t m_total_size = 0;
+
+        bool m_finished = false;
+
+        void compress(ZSTD_EndDirective mode) {
+            ZSTD_inBuffer input{ m_input.get(), m_input_size, 0 };
+            bool done;
+            do {
+                ZSTD_outBuffer output{ m_output.get(), m_output_size, 0 };
+                size_t remaining = ZSTD_compressStream2(m_context, &output, &input, mode);
+                if (ZSTD_isError(remaining)) {
+                    throw compression_error{ZSTD_getErrorName(remaining)};
+                }
+                if (output.pos != 0) {
+                    m_sink(std::string_view(m_output.get(), output.pos));
+                }
+                done = mode == ZSTD_e_continue ? input.pos == input.size : remaining == 0;
+            } while (!done);
+            m_input_size = 0;
+        }
+
+    public:
+        explicit zstd_buffer(Sink sink, int level = ZSTD_CLEVEL_DEFAULT)
+            : m_sink{std::move(sink)}
+            , m_context{ZSTD_createCCtx()}
+        {
+            if (!m_context) {
+                throw compression_error{"Error initializing zstd"};
+            }
+            size_t result = ZSTD_CCtx_setParameter(m_context, ZSTD_c_compressionLevel, level);
+            if (ZSTD_isError(result)) {
+                // the destructor won't run for a throwing constructor
+                ZSTD_freeCCtx(m_context);
+                throw compression_error{ZSTD_getErrorName(result)};
+            }
+        }
+
+        zstd_buffer(const zstd_buffer &) = delete;
+        zstd_buffer &operator = (const zstd_buffer &) = delete;
+
+        ~zstd_buffer() {
+            ZSTD_freeCCtx(m_context);
+        }
+
+        void append(std::string_view data) {
+            if (m_finished) {
+                throw compression_error{"Append after finish"};
+            }
+            m_total_size += data.size();
+            while (!data.empty()) {
+                size_t count = std::min(data.size(), m_block_size - m_input_size);
+                std::memcpy(m_input.get() + m_input_size, data.data(), count);
+                m_input_size += count;
+                data.remove_prefix(count);
+                if (m_input_size == m_block_size) {
+                    compress(ZSTD_e_continue);
+                }
+            }
+        }
+
+        size_t size() const {
+            return m_total_size;
+        }
+
+        void flush() {
+            compress(ZSTD_e_flush);
+        }
+
+        void finish() {
+            if (!m_finished) {
+                compress(ZSTD_e_end);
+                m_finished = true;
+            }
+        }
+    };
+
+    template<source Source>
+    class zstd_source {
+    private:
+        Source m_source;
+        ZSTD_DCtx *m_context;
+
+        size_t m_input_capacity = ZSTD_DStreamInSize();
+        size_t m_output_size = ZSTD_DStreamOutSize();
+
+        std::unique_ptr<char[]> m_input = std::make_unique_for_overwrite<char[]>(m_input_capacity);
+        std::unique_ptr<char[]> m_output = std::make_unique_for_overwrite<char[]>(m_output_size);
+        ZSTD_inBuffer m_buffer{ m_input.get(), 0, 0 };
+
+        bool m_finished = false;
+        bool m_output_full = false;
+
+    public:
+        explicit zstd_source(Source source)
+            : m_source{std::move(source)}
+            , m_context{ZSTD_createDCtx()}
+        {
+            if (!m_context) {
+                throw compression_error{"Error initializing zstd"};
+            }
+        }
+
+        zstd_source(const zstd_source &) = delete;
+        zstd_source &operator = (const zstd_source &) = delete;
+
+        ~zstd_source() {
+            ZSTD_freeDCtx(m_context);
+        }
+
+        std::string_view next() {
+            while (!m_finished) {
+                if (m_buffer.pos == m_buffer.size && !m_output_full) {
+                    size_t count = m_source(std::span<char>(m_input.get(), m_input_capacity));
+                    if (count == 0) {
+                        throw compression_error{"Unexpected end of compressed stream"};
+                    }
+                    m_buffer = ZSTD_inBuffer{ m_input.get(), count, 0 };
+                }
+
+                ZSTD_outBuffer output{ m_output.get(), m_output_size, 0 };
+                size_t result = ZSTD_decompressStream(m_context, &output, &m_buffer);
+                if (ZSTD_isError(result)) {
+                    throw compression_error{ZSTD_getErrorName(result)};
+                }
+                m_output_full = output.pos == output.size;
+                if (result == 0) {
+                    m_finished = true;
+                }
+
+                if (output.pos != 0) {
+                    return std::string_view(m_output.get(), output.pos);
+                }
+            }
+            return {};
+        }
+
+        void read_all(std::string &out) {
+            for (auto chunk = next(); !chunk.empty(); chunk = next()) {
+                out.append(chunk);
+            }
+        }
+    };
+
+#endif
+
+}
+
+#endif
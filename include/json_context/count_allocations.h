@@ -0,0 +1,63 @@
+#ifndef __COUNT_ALLOCATIONS_H__
+#define __COUNT_ALLOCATIONS_H__
+
+// Replaces the global operator new and delete so that every allocation bumps
+// instrumentation::allocation_count. Include from exactly one translation unit.
+
+#include <cstdlib>
+#include <new>
+
+#include "instrumentation.h"
+
+void *operator new(std::size_t size) {
+    if (size == 0) size = 1;
+    while (true) {
+        if (void *ptr = std::malloc(size)) {
+            ++json_context::instrumentation::allocation_count;
+            return ptr;
+        }
+        if (auto handler = std::get_new_handler()) {
+            handler();
+        } else {
+            throw std::bad_alloc{};
+        }
+    }
+}
+
+void *operator new(std::size_t size, std::align_val_t align) {
+    size_t alignment = static_cast<size_t>(align);
+    if (alignment < sizeof(void *)) alignment = sizeof(void *);
+    // aligned_alloc requires the size to be a multiple of the alignment
+    size = (size + alignment - 1) / alignment * alignment;
+    if (size == 0) size = alignment;
+    while (true) {
+        if (void *ptr = std::aligned_alloc(alignment, size)) {
+            ++json_context::instrumentation::allocation_count;
+            return ptr;
+        }
+        if (auto handler = std::get_new_handler()) {
+            handler();
+        } else {
+            throw std::bad_alloc{};
+        }
+    }
+}
+
+// The array, nothrow and sized forms forward to these by default.
+void operator delete(void *ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, std::align_val_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t, std::align_val_t) noexcept {
+    std::free(ptr);
+}
+
+#endif
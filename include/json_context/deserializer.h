@@ -1,7 +1,11 @@
 #ifndef __DESERIALIZER_H__
 #define __DESERIALIZER_H__
 
+#include <cmath>
+
 #include "reader.h"
+#include "instrumentation.h"
+#include "table_layout.h"
 
 #include "static_map.h"
 
@@ -12,82 +16,447 @@ namespace json_context {
     template<typename T, typename Context>
     concept deserializable = is_complete<deserializer<T, Context>>;
 
+    template<typename T>
+    using deserialize_result = std::expected<T, error_info>;
+
+    namespace detail {
+        template<typename R>
+        std::unexpected<error_info> make_error(R &reader, deserialize_errc code) {
+            if constexpr (requires { reader.bytes_read(); }) {
+                return std::unexpected(error_info{code, reader.bytes_read()});
+            } else {
+                return std::unexpected(error_info{code});
+            }
+        }
+
+        // Parsers may offer try_parse_* functions returning std::expected<T, deserialize_errc>;
+        // otherwise the plain parse_* functions are used and any exception they throw propagates.
+
+        template<typename T, typename R>
+        deserialize_result<T> parse_int(R &reader, std::string_view str) {
+            auto &&parser = reader.get_parser();
+            if constexpr (requires { parser.try_parse_int(str); }) {
+                auto value = parser.try_parse_int(str);
+                if (!value) return make_error(reader, value.error());
+                T result = static_cast<T>(*value);
+                if (static_cast<std::remove_cvref_t<decltype(*value)>>(result) != *value || (result < T{}) != (*value < 0)) {
+                    return make_error(reader, deserialize_errc::integer_out_of_range);
+                }
+                return result;
+            } else {
+                return static_cast<T>(parser.parse_int(str));
+            }
+        }
+
+        template<typename T, typename R>
+        deserialize_result<T> parse_float(R &reader, std::string_view str) {
+            auto &&parser = reader.get_parser();
+            if constexpr (requires { parser.try_parse_float(str); }) {
+                auto value = parser.try_parse_float(str);
+                if (!value) return make_error(reader, value.error());
+                T result = static_cast<T>(*value);
+                if (std::isfinite(*value) && !std::isfinite(result)) {
+                    return make_error(reader, deserialize_errc::float_out_of_range);
+                }
+                return result;
+            } else {
+                return static_cast<T>(parser.parse_float(str));
+            }
+        }
+
+        template<typename R>
+        deserialize_result<std::string> parse_string(R &reader, std::string_view str) {
+            auto &&parser = reader.get_parser();
+            if constexpr (requires { parser.try_parse_string(str); }) {
+                auto value = parser.try_parse_string(str);
+                if (!value) return make_error(reader, value.error());
+                return std::move(*value);
+            } else {
+                return parser.parse_string(str);
+            }
+        }
+
+        template<typename R>
+        deserialize_result<void> parse_string_into(R &reader, std::string_view str, std::string &out) {
+            auto &&parser = reader.get_parser();
+            if constexpr (requires { parser.try_parse_string_into(str, out); }) {
+                auto result = parser.try_parse_string_into(str, out);
+                if (!result) return make_error(reader, result.error());
+                return {};
+            } else {
+                auto value = parse_string(reader, str);
+                if (!value) return std::unexpected(value.error());
+                out = std::move(*value);
+                return {};
+            }
+        }
+
+        // Parsers may offer try_parse_key(str, scratch), returning either str itself when it
+        // decodes to itself or a view of scratch; otherwise keys go through parse_string_into.
+        // Either way scratch is reused, so matching a key doesn't allocate once it has grown.
+        template<typename R>
+        deserialize_result<std::string_view> parse_key(R &reader, std::string_view str, std::string &scratch) {
+            auto &&parser = reader.get_parser();
+            if constexpr (requires { parser.try_parse_key(str, scratch); }) {
+                auto key = parser.try_parse_key(str, scratch);
+                if (!key) return make_error(reader, key.error());
+                return *key;
+            } else {
+                if (auto result = parse_string_into(reader, str, scratch); !result) return std::unexpected(result.error());
+                return std::string_view{scratch};
+            }
+        }
+
+        template<typename R, typename Map>
+        deserialize_result<size_t> find_member_index(R &reader, std::string_view str, const Map &names_map) {
+            // keys are matched before any nested value is read, so one buffer per thread is enough
+            static thread_local std::string scratch;
+            auto key = parse_key(reader, str, scratch);
+            if (!key) return std::unexpected(key.error());
+            auto key_it = names_map.find(*key);
+            if (key_it == names_map.end()) return make_error(reader, deserialize_errc::unknown_key);
+            return key_it->second;
+        }
+
+        template<typename R, typename Map>
+        deserialize_result<size_t> read_member_index(R &object, const Map &names_map) {
+            auto key = object.read_key();
+            if (!key) return make_error(object, deserialize_errc::expected_key);
+            return find_member_index(object, *key, names_map);
+        }
+
+        template<typename T, typename Context, typename R>
+        deserialize_result<T> invoke_deserializer(R &reader, const Context &context) {
+            deserializer<T, Context> obj{};
+            if constexpr (requires { obj(reader, context); }) {
+                return obj(reader, context);
+            } else {
+                return obj(reader);
+            }
+        }
+
+        // Deserializers may offer an into(target, reader[, context]) overload that reuses the
+        // storage already owned by target; otherwise a new value is move assigned to it.
+        template<typename T, typename Context, typename R>
+        deserialize_result<void> invoke_deserializer_into(T &target, R &reader, const Context &context) {
+            deserializer<T, Context> obj{};
+            if constexpr (requires { obj.into(target, reader, context); }) {
+                return obj.into(target, reader, context);
+            } else if constexpr (requires { obj.into(target, reader); }) {
+                return obj.into(target, reader);
+            } else {
+                auto value = invoke_deserializer<T>(reader, context);
+                if (!value) return std::unexpected(value.error());
+                target = std::move(*value);
+                return {};
+            }
+        }
+    }
+
+    template<typename T, readers::reader R, typename Context = no_context> requires deserializable<T, Context>
+    deserialize_result<T> try_deserialize(R &reader, const Context &context = {}) {
+        if constexpr (instrumentation::instrumented_context<Context>) {
+            instrumentation::scope scope{context.instrumentation().template deserialize_stats<T>(), reader};
+            return detail::invoke_deserializer<T>(reader, context);
+        } else {
+            return detail::invoke_deserializer<T>(reader, context);
+        }
+    }
+
     template<typename T, readers::reader R, typename Context = no_context> requires deserializable<T, Context>
     T deserialize(R &reader, const Context &context = {}) {
-        deserializer<T, Context> obj{};
-        if constexpr (requires { obj(reader, context); }) {
-            return obj(reader, context);
+        auto result = try_deserialize<T>(reader, context);
+        if (!result) throw deserialize_error{result.error()};
+        return std::move(*result);
+    }
+
+    // Decodes into an existing object, reusing the capacity of its strings and vectors.
+    // On error target is left valid but with unspecified contents.
+    template<typename T, readers::reader R, typename Context = no_context> requires deserializable<T, Context>
+    deserialize_result<void> try_deserialize_into(T &target, R &reader, const Context &context = {}) {
+        if constexpr (instrumentation::instrumented_context<Context>) {
+            instrumentation::scope scope{context.instrumentation().template deserialize_stats<T>(), reader};
+            return detail::invoke_deserializer_into(target, reader, context);
         } else {
-            return obj(reader);
+            return detail::invoke_deserializer_into(target, reader, context);
         }
     }
 
+    template<typename T, readers::reader R, typename Context = no_context> requires deserializable<T, Context>
+    void deserialize_into(T &target, R &reader, const Context &context = {}) {
+        auto result = try_deserialize_into(target, reader, context);
+        if (!result) throw deserialize_error{result.error()};
+    }
+
     template<std::integral T, typename Context  >
     struct deserializer<T, Context> {
         template<readers::reader R>
-        T operator()(R &reader) const {
+        deserialize_result<T> operator()(R &reader) const {
             if (auto value = reader.read_int()) {
-                return reader.get_parser().parse_int(*value);
+                return detail::parse_int<T>(reader, *value);
             }
-            throw deserialize_error{"Expected integer"};
+            return detail::make_error(reader, deserialize_errc::expected_integer);
         }
     };
 
     template<std::floating_point T, typename Context  >
     struct deserializer<T, Context> {
         template<readers::reader R>
-        T operator()(R &reader) const {
+        deserialize_result<T> operator()(R &reader) const {
             if (auto value = reader.read_float()) {
-                return reader.get_parser().parse_float(*value);
+                return detail::parse_float<T>(reader, *value);
             }
-            throw deserialize_error{"Expected float"};
+            return detail::make_error(reader, deserialize_errc::expected_float);
         }
     };
 
     template<typename Context  >
     struct deserializer<std::string, Context> {
         template<readers::reader R>
-        std::string operator()(R &reader) const {
+        deserialize_result<std::string> operator()(R &reader) const {
+            if (auto value = reader.read_string()) {
+                return detail::parse_string(reader, *value);
+            }
+            return detail::make_error(reader, deserialize_errc::expected_string);
+        }
+
+        template<readers::reader R>
+        deserialize_result<void> into(std::string &target, R &reader) const {
             if (auto value = reader.read_string()) {
-                return reader.get_parser().parse_string(*value);
+                return detail::parse_string_into(reader, *value, target);
             }
-            throw deserialize_error{"Expected string"};
+            return detail::make_error(reader, deserialize_errc::expected_string);
         }
     };
 
     template<typename T, typename Context>
     requires deserializable<T, Context>
     struct deserializer<std::vector<T>, Context> {
+        static constexpr table_layout layout = get_table_layout<T, Context, deserializer>();
+
+        template<readers::reader R, size_t ... Is>
+        deserialize_result<std::vector<T>> read_rows(std::index_sequence<Is ...>, R &reader, const Context &ctx) const {
+            static constexpr size_t num_members = sizeof...(Is);
+
+            static constexpr auto names_map = utils::make_static_map<std::string_view, size_t>({
+                { reflect::member_name<Is, T>(), Is } ...
+            });
+
+            auto array = reader.begin_read_array();
+            if (!array) return detail::make_error(reader, deserialize_errc::expected_array);
+
+            std::vector<T> result;
+            if (array->read_end()) return result;
+
+            auto header = array->begin_read_array();
+            if (!header) return detail::make_error(*array, deserialize_errc::expected_array);
+
+            // positions[i] is the member stored in the i-th column of every row
+            std::array<size_t, num_members> positions;
+            std::array<bool, num_members> seen{};
+            size_t num_columns = 0;
+
+            while (!header->read_end()) {
+                auto key = header->read_string();
+                if (!key) return detail::make_error(*header, deserialize_errc::expected_key);
+
+                auto index = detail::find_member_index(*header, *key, names_map);
+                if (!index) return std::unexpected(index.error());
+                if (seen[*index]) return detail::make_error(*header, deserialize_errc::duplicate_field);
+
+                seen[*index] = true;
+                positions[num_columns++] = *index;
+            }
+
+            if (num_columns != num_members) return detail::make_error(*header, deserialize_errc::missing_field);
+
+            using row_tuple_type = std::tuple<std::optional<reflect::member_type<Is, T>> ...>;
+            using row_reader = std::remove_reference_t<decltype(*header)>;
+            using vtable_fun = deserialize_result<void> (*)(row_reader &reader, const Context &ctx, row_tuple_type &row);
+            static constexpr auto vtable = std::array<vtable_fun, num_members> {
+                [](row_reader &reader, const Context &ctx, row_tuple_type &row) -> deserialize_result<void> {
+                    auto value = try_deserialize<reflect::member_type<Is, T>>(reader, ctx);
+                    if (!value) return std::unexpected(value.error());
+                    std::get<Is>(row) = std::move(*value);
+                    return {};
+                } ...
+            };
+
+            while (!array->read_end()) {
+                auto row = array->begin_read_array();
+                if (!row) return detail::make_error(*array, deserialize_errc::expected_array);
+
+                row_tuple_type fields{};
+                for (size_t position : positions) {
+                    if (row->read_end()) return detail::make_error(*row, deserialize_errc::missing_field);
+                    auto field = vtable[position](*row, ctx, fields);
+                    if (!field) return std::unexpected(field.error());
+                }
+                if (!row->read_end()) return detail::make_error(*row, deserialize_errc::expected_array_end);
+
+                result.push_back(T{ std::move(*std::get<Is>(fields)) ... });
+            }
+
+            return result;
+        }
+
+        template<readers::reader R, size_t ... Is>
+        deserialize_result<std::vector<T>> read_columns(std::index_sequence<Is ...>, R &reader, const Context &ctx) const {
+            static constexpr size_t num_members = sizeof...(Is);
+
+            static constexpr auto names_map = utils::make_static_map<std::string_view, size_t>({
+                { reflect::member_name<Is, T>(), Is } ...
+            });
+
+            auto object = reader.begin_read_object();
+            if (!object) return detail::make_error(reader, deserialize_errc::expected_object);
+
+            using columns_tuple_type = std::tuple<std::optional<std::vector<reflect::member_type<Is, T>>> ...>;
+            columns_tuple_type columns{};
+
+            using object_reader = std::remove_reference_t<decltype(*object)>;
+            using vtable_fun = deserialize_result<void> (*)(object_reader &reader, const Context &ctx, columns_tuple_type &columns);
+            static constexpr auto vtable = std::array<vtable_fun, num_members> {
+                [](object_reader &reader, const Context &ctx, columns_tuple_type &columns) -> deserialize_result<void> {
+                    auto &column = std::get<Is>(columns);
+                    if (column.has_value()) return detail::make_error(reader, deserialize_errc::duplicate_field);
+
+                    // read element by element, a nested vector could have a table layout of its own
+                    auto array = reader.begin_read_array();
+                    if (!array) return detail::make_error(reader, deserialize_errc::expected_array);
+
+                    auto &values = column.emplace();
+                    while (!array->read_end()) {
+                        auto value = try_deserialize<reflect::member_type<Is, T>>(*array, ctx);
+                        if (!value) return std::unexpected(value.error());
+                        values.push_back(std::move(*value));
+                    }
+                    return {};
+                } ...
+            };
+
+            size_t count = 0;
+
+            while (!object->read_end()) {
+                auto index = detail::read_member_index(*object, names_map);
+                if (!index) return std::unexpected(index.error());
+
+                auto field = vtable[*index](*object, ctx, columns);
+                if (!field) return std::unexpected(field.error());
+
+                ++count;
+            }
+
+            if (count != num_members) return detail::make_error(*object, deserialize_errc::missing_field);
+
+            size_t size = std::get<0>(columns)->size();
+            if (((std::get<Is>(columns)->size() != size) || ...)) {
+                return detail::make_error(*object, deserialize_errc::column_size_mismatch);
+            }
+
+            std::vector<T> result;
+            result.reserve(size);
+            for (size_t i = 0; i < size; ++i) {
+                result.push_back(T{ std::move((*std::get<Is>(columns))[i]) ... });
+            }
+            return result;
+        }
+
         template<readers::reader R>
-        std::vector<T> operator()(R &reader, const Context &ctx) const {
+        deserialize_result<std::vector<T>> read_values(R &reader, const Context &ctx) const {
             std::vector<T> result;
 
             auto opt_array = reader.begin_read_array();
-            if (!opt_array) throw deserialize_error{"Expected array"};
+            if (!opt_array) return detail::make_error(reader, deserialize_errc::expected_array);
             auto &array = *opt_array;
 
             while (!array.read_end()) {
-                result.push_back(deserialize<T>(array, ctx));
+                auto value = try_deserialize<T>(array, ctx);
+                if (!value) return std::unexpected(value.error());
+                result.push_back(std::move(*value));
             }
 
             return result;
         }
+
+        template<readers::reader R>
+        deserialize_result<std::vector<T>> operator()(R &reader, const Context &ctx) const {
+            if constexpr (layout == table_layout::rows) {
+                return read_rows(std::make_index_sequence<reflect::size<T>()>(), reader, ctx);
+            } else if constexpr (layout == table_layout::columns) {
+                return read_columns(std::make_index_sequence<reflect::size<T>()>(), reader, ctx);
+            } else {
+                return read_values(reader, ctx);
+            }
+        }
+
+        // Overwrites the existing elements in place, then appends or erases the excess.
+        template<readers::reader R>
+        deserialize_result<void> into(std::vector<T> &target, R &reader, const Context &ctx) const {
+            if constexpr (layout != table_layout::none) {
+                auto value = (*this)(reader, ctx);
+                if (!value) return std::unexpected(value.error());
+                target = std::move(*value);
+                return {};
+            } else {
+                auto opt_array = reader.begin_read_array();
+                if (!opt_array) return detail::make_error(reader, deserialize_errc::expected_array);
+                auto &array = *opt_array;
+
+                size_t count = 0;
+                while (!array.read_end()) {
+                    if constexpr (std::is_same_v<typename std::vector<T>::reference, T &>) {
+                        if (count < target.size()) {
+                            auto result = try_deserialize_into(target[count], array, ctx);
+                            if (!result) return result;
+                            ++count;
+                            continue;
+                        }
+                    }
+                    auto value = try_deserialize<T>(array, ctx);
+                    if (!value) return std::unexpected(value.error());
+                    if (count < target.size()) {
+                        target[count] = std::move(*value);
+                    } else {
+                        target.push_back(std::move(*value));
+                    }
+                    ++count;
+                }
+
+                target.erase(target.begin() + count, target.end());
+                return {};
+            }
+        }
     };
-    
+
     template<typename First, typename Second, typename Context>
     requires (deserializable<First, Context> && deserializable<Second, Context>)
     struct deserializer<std::pair<First, Second>, Context> {
         template<readers::reader R>
-        std::pair<First, Second> operator()(R &reader, const Context &ctx) const {
+        deserialize_result<std::pair<First, Second>> operator()(R &reader, const Context &ctx) const {
             auto array = reader.begin_read_array();
-            if (!array) throw deserialize_error{"Expected array"};
+            if (!array) return detail::make_error(reader, deserialize_errc::expected_array);
+
+            auto first = try_deserialize<First>(*array, ctx);
+            if (!first) return std::unexpected(first.error());
+            auto second = try_deserialize<Second>(*array, ctx);
+            if (!second) return std::unexpected(second.error());
+
+            if (!array->read_end()) return detail::make_error(*array, deserialize_errc::expected_array_end);
+
+            return std::pair<First, Second>{ std::move(*first), std::move(*second) };
+        }
 
-            auto first = deserialize<First>(*array, ctx);
-            auto second = deserialize<Second>(*array, ctx);
+        template<readers::reader R>
+        deserialize_result<void> into(std::pair<First, Second> &target, R &reader, const Context &ctx) const {
+            auto array = reader.begin_read_array();
+            if (!array) return detail::make_error(reader, deserialize_errc::expected_array);
 
-            if (!array->read_end()) throw deserialize_error{"Expected array end"};
+            if (auto result = try_deserialize_into(target.first, *array, ctx); !result) return result;
+            if (auto result = try_deserialize_into(target.second, *array, ctx); !result) return result;
 
-            return { std::move(first), std::move(second) };
+            if (!array->read_end()) return detail::make_error(*array, deserialize_errc::expected_array_end);
+            return {};
         }
     };
 
@@ -97,29 +466,56 @@ namespace json_context {
         using tuple_type = std::tuple<Ts ...>;
 
         template<readers::reader R>
-        tuple_type operator()(R &reader, const Context &ctx) const {
+        deserialize_result<tuple_type> operator()(R &reader, const Context &ctx) const {
             auto array = reader.begin_read_array();
-            if (!array) throw deserialize_error{"Expected array"};
+            if (!array) return detail::make_error(reader, deserialize_errc::expected_array);
 
-            auto result = [&]<size_t ... Is>(std::index_sequence<Is ...>) {
+            return [&]<size_t ... Is>(std::index_sequence<Is ...>) -> deserialize_result<tuple_type> {
                 std::tuple<std::optional<Ts> ...> opts{};
-                ((std::get<Is>(opts) = deserialize<Ts>(*array, ctx)), ...);
+                std::optional<error_info> error;
+
+                bool success = ([&] {
+                    auto value = try_deserialize<Ts>(*array, ctx);
+                    if (!value) {
+                        error = value.error();
+                        return false;
+                    }
+                    std::get<Is>(opts) = std::move(*value);
+                    return true;
+                }() && ...);
+
+                if (!success) return std::unexpected(*error);
+                if (!array->read_end()) return detail::make_error(*array, deserialize_errc::expected_array_end);
+
+                return tuple_type{ std::move(*std::get<Is>(opts)) ... };
+            }(std::index_sequence_for<Ts ...>());
+        }
 
-                return tuple_type{ std::move(std::get<Is>(opts)) ... };
+        template<readers::reader R>
+        deserialize_result<void> into(tuple_type &target, R &reader, const Context &ctx) const {
+            auto array = reader.begin_read_array();
+            if (!array) return detail::make_error(reader, deserialize_errc::expected_array);
+
+            deserialize_result<void> result{};
+            [&]<size_t ... Is>(std::index_sequence<Is ...>) {
+                ((result = try_deserialize_into(std::get<Is>(target), *array, ctx)) && ...);
             }(std::index_sequence_for<Ts ...>());
+            if (!result) return result;
 
-            if (!array->read_end()) throw deserialize_error{"Expected array end"};
-            return result;
+            if (!array->read_end()) return detail::make_error(*array, deserialize_errc::expected_array_end);
+            return {};
         }
     };
 
     template<aggregate T, typename Context>
     struct deserializer<T, Context> {
+        static constexpr bool builtin_aggregate = true;
+
         template<readers::reader R, size_t ... Is>
-        T deserialize_helper(std::index_sequence<Is ...>, R &reader, const Context &ctx) const {
+        deserialize_result<T> deserialize_helper(std::index_sequence<Is ...>, R &reader, const Context &ctx) const {
             auto object = reader.begin_read_object();
-            if (!object) throw deserialize_error{"Expected object"};
-            
+            if (!object) return detail::make_error(reader, deserialize_errc::expected_object);
+
             using result_tuple_type = std::tuple<std::optional<reflect::member_type<Is, T>> ...>;
             result_tuple_type result{};
 
@@ -127,82 +523,154 @@ namespace json_context {
                 { reflect::member_name<Is, T>(), Is } ...
             });
 
-            using object_reader = decltype(*object);
-            using vtable_fun = void (*)(std::string_view key, object_reader &reader, const Context &ctx, result_tuple_type &result);
-            static constexpr auto vtable = std::array<vtable_fun, sizeof...(Ts)> {
-                [](std::string_view key, object_reader &reader, const Context &ctx, result_tuple_type &result) {
+            using object_reader = std::remove_reference_t<decltype(*object)>;
+            using vtable_fun = deserialize_result<void> (*)(object_reader &reader, const Context &ctx, result_tuple_type &result);
+            static constexpr auto vtable = std::array<vtable_fun, sizeof...(Is)> {
+                [](object_reader &reader, const Context &ctx, result_tuple_type &result) -> deserialize_result<void> {
                     auto &member = std::get<Is>(result);
-                    if (member.has_value()) throw deserialize_error{std::format("Duplicate field: {}", key)};
-                    member = deserialize<reader::member_type<Is, T>>(reader, ctx);
+                    if (member.has_value()) return detail::make_error(reader, deserialize_errc::duplicate_field);
+                    auto value = try_deserialize<reflect::member_type<Is, T>>(reader, ctx);
+                    if (!value) return std::unexpected(value.error());
+                    member = std::move(*value);
+                    return {};
                 } ...
             };
 
             size_t count = 0;
 
             while (!object->read_end()) {
-                auto key = object->read_key();
-                if (!key) throw deserialize_error{"Expected key"};
+                auto index = detail::read_member_index(*object, names_map);
+                if (!index) return std::unexpected(index.error());
+
+                auto field = vtable[*index](*object, ctx, result);
+                if (!field) return std::unexpected(field.error());
+
+                ++count;
+            }
+
+            if (count != sizeof...(Is)) return detail::make_error(*object, deserialize_errc::missing_field);
+
+            return T{ std::move(*(std::get<Is>(result))) ... };
+        }
+
+        template<readers::reader R, size_t ... Is>
+        deserialize_result<void> into_helper(std::index_sequence<Is ...>, T &target, R &reader, const Context &ctx) const {
+            auto object = reader.begin_read_object();
+            if (!object) return detail::make_error(reader, deserialize_errc::expected_object);
+
+            static constexpr auto names_map = utils::make_static_map<std::string_view, size_t>({
+                { reflect::member_name<Is, T>(), Is } ...
+            });
+
+            using seen_type = std::array<bool, sizeof...(Is)>;
+            seen_type seen{};
+
+            using object_reader = std::remove_reference_t<decltype(*object)>;
+            using vtable_fun = deserialize_result<void> (*)(object_reader &reader, const Context &ctx, T &target, seen_type &seen);
+            static constexpr auto vtable = std::array<vtable_fun, sizeof...(Is)> {
+                [](object_reader &reader, const Context &ctx, T &target, seen_type &seen) -> deserialize_result<void> {
+                    if (seen[Is]) return detail::make_error(reader, deserialize_errc::duplicate_field);
+                    seen[Is] = true;
+                    return try_deserialize_into(reflect::get<Is>(target), reader, ctx);
+                } ...
+            };
 
-                auto key_str = object->get_parser().parse_string(*key);
+            size_t count = 0;
 
-                auto key_it = names_map.find(key_str);
-                if (key_it == names_map.end()) throw deserialize_error{std::format("Cannot find key {}", key_str)};
+            while (!object->read_end()) {
+                auto index = detail::read_member_index(*object, names_map);
+                if (!index) return std::unexpected(index.error());
 
-                vtable[key_it->second](key_str, *object, ctx, result);
+                auto field = vtable[*index](*object, ctx, target, seen);
+                if (!field) return field;
 
                 ++count;
             }
 
-            if (count != sizeof...(Ts)) throw deserialize_error{"Field missing"};
-            
-            return T{ std::move(*(std::get<Is>(result))) ... };
+            if (count != sizeof...(Is)) return detail::make_error(*object, deserialize_errc::missing_field);
+            return {};
         }
 
         template<readers::reader R>
-        T operator()(R &reader, const Context &ctx) const {
+        deserialize_result<T> operator()(R &reader, const Context &ctx) const {
             return deserialize_helper(std::make_index_sequence<reflect::size<T>()>(), reader, ctx);
         }
+
+        template<readers::reader R>
+        deserialize_result<void> into(T &target, R &reader, const Context &ctx) const {
+            return into_helper(std::make_index_sequence<reflect::size<T>()>(), target, reader, ctx);
+        }
     };
 
     template<typename Context, typename ... Ts> requires (deserializable<Ts, Context> && ...)
     struct deserializer<std::variant<Ts ...>, Context> {
         using variant_type = std::variant<Ts ...>;
 
+        static constexpr auto names_map = []<size_t ... Is>(std::index_sequence<Is ...>) {
+            return utils::make_static_map<std::string_view, size_t>({
+                { reflect::type_name<Ts>(), Is } ...
+            });
+        }(std::index_sequence_for<Ts ...>());
+
         template<readers::reader R>
-        variant_type operator()(R &reader, const Context &ctx) const {
+        deserialize_result<variant_type> operator()(R &reader, const Context &ctx) const {
             auto object = reader.begin_read_object();
-            if (!object) throw deserialize_error{"Expected object"};
-
-            static constexpr auto names_map = []<size_t ... Is>(std::index_sequence<Is ...>) {
-                return utils::make_static_map<std::string_view, size_t>({
-                    { reflect::type_name<Ts>(), Is } ...
-                });
-            }(std::index_sequence_for<Ts ...>());
-
-            auto key = object->read_key();
-            if (!key) throw deserialize_error{"Expected key"};
-
-            auto key_str = reader.get_parser().parse_string(*key);
+            if (!object) return detail::make_error(reader, deserialize_errc::expected_object);
 
-            auto key_it = names_map.find(key_str);
-            if (key_it == names_map.end()) throw deserialize_error{std::format("Cannot find key {}", key_str)};
+            auto index = detail::read_member_index(*object, names_map);
+            if (!index) return std::unexpected(index.error());
 
-            using object_reader = decltype(*object);
-            using vtable_fun = variant_type (*)(object_reader &reader, const Context &ctx);
+            using object_reader = std::remove_reference_t<decltype(*object)>;
+            using vtable_fun = deserialize_result<variant_type> (*)(object_reader &reader, const Context &ctx);
             static constexpr auto vtable = std::array<vtable_fun, sizeof...(Ts)> {
-                [](object_reader &reader, const Context &ctx) -> variant_type {
-                    return deserialize<Ts>(reader, ctx);
+                [](object_reader &reader, const Context &ctx) -> deserialize_result<variant_type> {
+                    auto value = try_deserialize<Ts>(reader, ctx);
+                    if (!value) return std::unexpected(value.error());
+                    return variant_type{ std::in_place_type<Ts>, std::move(*value) };
                 } ...
             };
 
-            auto result = vtable[key_it->second](*object, ctx);
+            auto result = vtable[*index](*object, ctx);
+            if (!result) return result;
 
-            if (!object->read_end()) throw deserialize_error{"Expected object end"};
+            if (!object->read_end()) return detail::make_error(*object, deserialize_errc::expected_object_end);
 
             return result;
         }
+
+        // Decodes in place when the stored alternative matches, otherwise replaces it.
+        template<readers::reader R>
+        deserialize_result<void> into(variant_type &target, R &reader, const Context &ctx) const {
+            auto object = reader.begin_read_object();
+            if (!object) return detail::make_error(reader, deserialize_errc::expected_object);
+
+            auto index = detail::read_member_index(*object, names_map);
+            if (!index) return std::unexpected(index.error());
+
+            using object_reader = std::remove_reference_t<decltype(*object)>;
+            using vtable_fun = deserialize_result<void> (*)(object_reader &reader, const Context &ctx, variant_type &target);
+            static constexpr auto vtable = []<size_t ... Is>(std::index_sequence<Is ...>) {
+                return std::array<vtable_fun, sizeof...(Ts)> {
+                    [](object_reader &reader, const Context &ctx, variant_type &target) -> deserialize_result<void> {
+                        if (target.index() == Is) {
+                            return try_deserialize_into(std::get<Is>(target), reader, ctx);
+                        }
+                        auto value = try_deserialize<std::variant_alternative_t<Is, variant_type>>(reader, ctx);
+                        if (!value) return std::unexpected(value.error());
+                        target.template emplace<Is>(std::move(*value));
+                        return {};
+                    } ...
+                };
+            }(std::index_sequence_for<Ts ...>());
+
+            auto result = vtable[*index](*object, ctx, target);
+            if (!result) return result;
+
+            if (!object->read_end()) return detail::make_error(*object, deserialize_errc::expected_object_end);
+            return {};
+        }
     };
 
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,179 @@
+#ifndef __INSTRUMENTATION_H__
+#define __INSTRUMENTATION_H__
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+
+#include "types.h"
+
+namespace json_context::instrumentation {
+
+    struct type_stats {
+        size_t calls = 0;
+        size_t bytes = 0;
+        size_t allocations = 0;
+        std::chrono::nanoseconds time{};
+    };
+
+    struct type_entry {
+        std::string_view name;
+        type_stats serialize;
+        type_stats deserialize;
+    };
+
+    // Incremented by the operator new replacement in count_allocations.h;
+    // without it every type reports zero allocations.
+    inline thread_local size_t allocation_count = 0;
+
+    namespace detail {
+        inline size_t next_type_id() {
+            static std::atomic<size_t> counter = 0;
+            return counter++;
+        }
+
+        template<typename T>
+        size_t type_id() {
+            static const size_t id = next_type_id();
+            return id;
+        }
+    }
+
+    // Not synchronized: a registry belongs to the thread that serializes with it.
+    // Give each thread its own registry and merge() them into one for the report.
+    class registry {
+    private:
+        std::vector<std::unique_ptr<type_entry>> m_entries;
+
+        static void add_stats(type_stats &to, const type_stats &from) {
+            to.calls += from.calls;
+            to.bytes += from.bytes;
+            to.allocations += from.allocations;
+            to.time += from.time;
+        }
+
+        template<typename T>
+        type_entry &get_entry() {
+            size_t id = detail::type_id<T>();
+            if (id >= m_entries.size()) {
+                m_entries.resize(id + 1);
+            }
+            auto &entry = m_entries[id];
+            if (!entry) {
+                entry = std::make_unique<type_entry>(reflect::type_name<T>());
+            }
+            return *entry;
+        }
+
+    public:
+        template<typename T>
+        type_stats &serialize_stats() {
+            return get_entry<T>().serialize;
+        }
+
+        template<typename T>
+        type_stats &deserialize_stats() {
+            return get_entry<T>().deserialize;
+        }
+
+        auto entries() const {
+            return m_entries
+                | std::views::filter([](const auto &entry) { return entry != nullptr; })
+                | std::views::transform([](const auto &entry) -> const type_entry & { return *entry; });
+        }
+
+        void reset() {
+            m_entries.clear();
+        }
+
+        // Adds the counters of other, which must not be in use by another thread meanwhile.
+        void merge(const registry &other) {
+            if (other.m_entries.size() > m_entries.size()) {
+                m_entries.resize(other.m_entries.size());
+            }
+            for (size_t id = 0; id < other.m_entries.size(); ++id) {
+                const auto &from = other.m_entries[id];
+                if (!from) continue;
+                auto &entry = m_entries[id];
+                if (!entry) {
+                    entry = std::make_unique<type_entry>(from->name);
+                }
+                add_stats(entry->serialize, from->serialize);
+                add_stats(entry->deserialize, from->deserialize);
+            }
+        }
+
+        // Times are inclusive: a type's time also counts the nested values it contains.
+        std::string report() const {
+            std::vector<const type_entry *> sorted;
+            for (const auto &entry : entries()) {
+                sorted.push_back(&entry);
+            }
+            std::ranges::sort(sorted, std::greater{}, [](const type_entry *entry) {
+                return entry->serialize.time + entry->deserialize.time;
+            });
+
+            std::string result = std::format("{:<40} {:>5} {:>12} {:>12} {:>14} {:>12}\n",
+                "type", "op", "calls", "bytes", "nanoseconds", "allocations");
+            auto append_line = [&](std::string_view name, std::string_view op, const type_stats &stats) {
+                if (stats.calls == 0) return;
+                result.append(std::format("{:<40} {:>5} {:>12} {:>12} {:>14} {:>12}\n",
+                    name, op, stats.calls, stats.bytes, stats.time.count(), stats.allocations));
+            };
+            for (const type_entry *entry : sorted) {
+                append_line(entry->name, "ser", entry->serialize);
+                append_line(entry->name, "de", entry->deserialize);
+            }
+            return result;
+        }
+    };
+
+    template<typename Context>
+    concept instrumented_context = requires (const Context &ctx) {
+        { ctx.instrumentation() } -> std::same_as<registry &>;
+    };
+
+    template<typename T>
+    size_t byte_position(T &v) {
+        if constexpr (requires { v.bytes_written(); }) {
+            return v.bytes_written();
+        } else if constexpr (requires { v.bytes_read(); }) {
+            return v.bytes_read();
+        } else {
+            return 0;
+        }
+    }
+
+    template<typename Stream>
+    class scope {
+    private:
+        type_stats &stats;
+        Stream &stream;
+
+        size_t start_bytes;
+        size_t start_allocations;
+        std::chrono::steady_clock::time_point start_time;
+
+    public:
+        scope(type_stats &stats, Stream &stream)
+            : stats{stats}
+            , stream{stream}
+            , start_bytes{byte_position(stream)}
+            , start_allocations{allocation_count}
+            , start_time{std::chrono::steady_clock::now()} {}
+
+        scope(const scope &) = delete;
+        scope &operator = (const scope &) = delete;
+
+        ~scope() {
+            stats.time += std::chrono::steady_clock::now() - start_time;
+            stats.allocations += allocation_count - start_allocations;
+            stats.bytes += byte_position(stream) - start_bytes;
+            ++stats.calls;
+        }
+    };
+
+}
+
+#endif
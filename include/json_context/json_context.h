@@ -3,17 +3,35 @@
 
 #include "json_writer.h"
 #include "serializer.h"
+#include "buffer_pool.h"
 
 namespace json_context {
 
+    // Overwrites out, keeping its capacity.
+    template<typename T, writers::json_writer_options Options = writers::json_writer_options{}, typename Context = no_context>
+    requires serializable<T, Context>
+    void to_json_into(std::string &out, const T &value, const Context &ctx = {}) {
+        out.clear();
+        writers::json_writer<std::string, Options> writer{out};
+        serialize(writer, value, ctx);
+    }
+
     template<typename T, writers::json_writer_options Options = writers::json_writer_options{}, typename Context = no_context>
     requires serializable<T, Context>
     auto to_string_json(const T &value, const Context &ctx = {}) {
         std::string buf;
-        writers::json_writer<std::string, Options> writer{buf};
-        serialize(writer, value, ctx);
+        to_json_into<T, Options>(buf, value, ctx);
+        return buf;
+    }
+
+    // Serializes into a buffer from the thread local pool, which gets it back when the result is destroyed.
+    template<typename T, writers::json_writer_options Options = writers::json_writer_options{}, typename Context = no_context>
+    requires serializable<T, Context>
+    pooled_buffer to_json_pooled(const T &value, const Context &ctx = {}) {
+        auto buf = buffer_pool::local().acquire();
+        to_json_into<T, Options>(buf.str(), value, ctx);
         return buf;
     }
 }
 
-#endif
\ No newline at end of file
+#endif
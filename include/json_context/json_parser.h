@@ -0,0 +1,228 @@
+#ifndef __JSON_PARSER_H__
+#define __JSON_PARSER_H__
+
+#include <charconv>
+
+#include "reader.h"
+#include "utf8.h"
+#include "swar.h"
+
+namespace json_context::readers {
+
+    struct json_parser_options {
+        utf8_mode utf8 = utf8_mode::trust;
+    };
+
+    template<json_parser_options Options = json_parser_options{}>
+    class json_parser {
+    private:
+        static constexpr bool validate_utf8 = Options.utf8 != utf8_mode::trust;
+
+        static size_t find_special(std::string_view str, size_t i) {
+            for (; i + swar::word_size <= str.size(); i += swar::word_size) {
+                auto word = swar::load(str.data() + i);
+                auto mask = swar::has_byte(word, '\\');
+                if constexpr (validate_utf8) {
+                    mask |= swar::has_non_ascii(word);
+                }
+                if (mask) {
+                    return i + swar::first_index(mask);
+                }
+            }
+            for (; i < str.size(); ++i) {
+                unsigned char c = str[i];
+                if (c == '\\' || (validate_utf8 && c >= 0x80)) break;
+            }
+            return i;
+        }
+
+        static std::optional<char32_t> parse_hex4(std::string_view str, size_t i) {
+            if (i + 4 > str.size()) return std::nullopt;
+            uint32_t value = 0;
+            auto [end, ec] = std::from_chars(str.data() + i, str.data() + i + 4, value, 16);
+            if (ec != std::errc{} || end != str.data() + i + 4) return std::nullopt;
+            return value;
+        }
+
+        static bool append_invalid(std::string &result) {
+            if constexpr (Options.utf8 == utf8_mode::reject) {
+                return false;
+            }
+            result.append(utf8::replacement_character);
+            return true;
+        }
+
+        static size_t skip_digits(std::string_view str, size_t i) {
+            while (i < str.size() && str[i] >= '0' && str[i] <= '9') ++i;
+            return i;
+        }
+
+        // Matches -?(0|[1-9][0-9]*), plus (\.[0-9]+)?([eE][+-]?[0-9]+)? unless integer is set.
+        // from_chars alone would also take nan, inf, .5, 1. and 01.
+        static bool is_json_number(std::string_view str, bool integer) {
+            size_t i = 0;
+            if (i < str.size() && str[i] == '-') ++i;
+            if (i >= str.size()) return false;
+            if (str[i] == '0') {
+                ++i;
+            } else {
+                size_t begin = i;
+                i = skip_digits(str, i);
+                if (i == begin) return false;
+            }
+            if (integer) return i == str.size();
+            if (i < str.size() && str[i] == '.') {
+                size_t begin = ++i;
+                i = skip_digits(str, i);
+                if (i == begin) return false;
+            }
+            if (i < str.size() && (str[i] == 'e' || str[i] == 'E')) {
+                ++i;
+                if (i < str.size() && (str[i] == '+' || str[i] == '-')) ++i;
+                size_t begin = i;
+                i = skip_digits(str, i);
+                if (i == begin) return false;
+            }
+            return i == str.size();
+        }
+
+        template<typename T>
+        static T value_or_throw(std::expected<T, deserialize_errc> &&result) {
+            if (!result) throw deserialize_error{error_info{result.error()}};
+            return std::move(*result);
+        }
+
+    public:
+        // Takes the contents of a string token without the surrounding quotes.
+        // Unescaping and, unless Options.utf8 is trust, UTF-8 validation happen in the same pass.
+        // Overwrites result, reusing its capacity.
+        std::expected<void, deserialize_errc> try_parse_string_into(std::string_view str, std::string &result) const {
+            result.clear();
+            result.reserve(str.size());
+
+            size_t run_start = 0;
+            size_t i = 0;
+            while ((i = find_special(str, i)) < str.size()) {
+                result.append(str.substr(run_start, i - run_start));
+
+                if (str[i] != '\\') {
+                    auto seq = utf8::check_sequence(str.data() + i, str.size() - i);
+                    if (seq.valid) {
+                        result.append(str.substr(i, seq.length));
+                    } else if (!append_invalid(result)) {
+                        return std::unexpected(deserialize_errc::invalid_utf8);
+                    }
+                    i += seq.length;
+                    run_start = i;
+                    continue;
+                }
+
+                if (++i >= str.size()) return std::unexpected(deserialize_errc::invalid_escape);
+                switch (str[i++]) {
+                case '"':  result.push_back('"'); break;
+                case '\\': result.push_back('\\'); break;
+                case '/':  result.push_back('/'); break;
+                case 'b':  result.push_back('\b'); break;
+                case 'f':  result.push_back('\f'); break;
+                case 'n':  result.push_back('\n'); break;
+                case 'r':  result.push_back('\r'); break;
+                case 't':  result.push_back('\t'); break;
+                case 'u': {
+                    auto cp = parse_hex4(str, i);
+                    if (!cp) return std::unexpected(deserialize_errc::invalid_escape);
+                    i += 4;
+                    bool valid = true;
+                    if (*cp >= 0xd800 && *cp <= 0xdbff) {
+                        std::optional<char32_t> low;
+                        if (str.substr(i, 2) == "\\u") {
+                            low = parse_hex4(str, i + 2);
+                        }
+                        if (low && *low >= 0xdc00 && *low <= 0xdfff) {
+                            utf8::append_codepoint(result, 0x10000 + ((*cp - 0xd800) << 10) + (*low - 0xdc00));
+                            i += 6;
+                        } else {
+                            valid = append_invalid(result);
+                        }
+                    } else if (*cp >= 0xdc00 && *cp <= 0xdfff) {
+                        valid = append_invalid(result);
+                    } else {
+                        utf8::append_codepoint(result, *cp);
+                    }
+                    if (!valid) return std::unexpected(deserialize_errc::invalid_utf8);
+                    break;
+                }
+                default:
+                    return std::unexpected(deserialize_errc::invalid_escape);
+                }
+                run_start = i;
+            }
+            result.append(str.substr(run_start));
+            return {};
+        }
+
+        std::expected<std::string, deserialize_errc> try_parse_string(std::string_view str) const {
+            std::string result;
+            if (auto parsed = try_parse_string_into(str, result); !parsed) {
+                return std::unexpected(parsed.error());
+            }
+            return result;
+        }
+
+        // Returns str itself when it contains nothing to unescape or validate,
+        // otherwise decodes it into scratch and returns a view of that.
+        std::expected<std::string_view, deserialize_errc> try_parse_key(std::string_view str, std::string &scratch) const {
+            if (find_special(str, 0) == str.size()) {
+                return str;
+            }
+            if (auto parsed = try_parse_string_into(str, scratch); !parsed) {
+                return std::unexpected(parsed.error());
+            }
+            return std::string_view{scratch};
+        }
+
+        std::expected<int64_t, deserialize_errc> try_parse_int(std::string_view str) const {
+            if (!is_json_number(str, true)) {
+                return std::unexpected(deserialize_errc::invalid_integer);
+            }
+            int64_t value;
+            auto [end, ec] = std::from_chars(str.data(), str.data() + str.size(), value);
+            if (ec == std::errc::result_out_of_range) {
+                return std::unexpected(deserialize_errc::integer_out_of_range);
+            }
+            if (ec != std::errc{} || end != str.data() + str.size()) {
+                return std::unexpected(deserialize_errc::invalid_integer);
+            }
+            return value;
+        }
+
+        std::expected<double, deserialize_errc> try_parse_float(std::string_view str) const {
+            if (!is_json_number(str, false)) {
+                return std::unexpected(deserialize_errc::invalid_float);
+            }
+            double value;
+            auto [end, ec] = std::from_chars(str.data(), str.data() + str.size(), value);
+            if (ec == std::errc::result_out_of_range) {
+                return std::unexpected(deserialize_errc::float_out_of_range);
+            }
+            if (ec != std::errc{} || end != str.data() + str.size()) {
+                return std::unexpected(deserialize_errc::invalid_float);
+            }
+            return value;
+        }
+
+        std::string parse_string(std::string_view str) const {
+            return value_or_throw(try_parse_string(str));
+        }
+
+        int64_t parse_int(std::string_view str) const {
+            return value_or_throw(try_parse_int(str));
+        }
+
+        double parse_float(std::string_view str) const {
+            return value_or_throw(try_parse_float(str));
+        }
+    };
+
+}
+
+#endif
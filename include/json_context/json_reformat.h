@@ -0,0 +1,190 @@
+#ifndef __JSON_REFORMAT_H__
+#define __JSON_REFORMAT_H__
+
+#include "json_writer.h"
+
+namespace json_context {
+
+    namespace detail {
+
+        // Re-lays out already serialized JSON without parsing values: strings and scalars
+        // are copied in bulk and only the whitespace between tokens is rewritten,
+        // exactly where json_writer<Options> would put it.
+        template<writers::output_buffer Buffer, writers::json_writer_options Options>
+        class json_reformatter {
+        private:
+            std::string_view input;
+            Buffer &buffer;
+
+            size_t pos = 0;
+            std::vector<char> closing;
+
+            static constexpr auto scalar_chars = [] {
+                std::array<bool, 256> table{};
+                for (size_t i = 0x21; i < table.size(); ++i) {
+                    table[i] = true;
+                }
+                for (unsigned char c : std::string_view{"\",:[]{}"}) {
+                    table[c] = false;
+                }
+                return table;
+            }();
+
+            static bool is_whitespace(char c) {
+                return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+            }
+
+            void skip_whitespace() {
+                while (pos < input.size()) {
+                    for (; pos + swar::word_size <= input.size(); pos += swar::word_size) {
+                        auto mask = swar::non_zero(swar::load(input.data() + pos) ^ (swar::ones * ' '));
+                        if (mask) {
+                            pos += swar::first_index(mask);
+                            break;
+                        }
+                    }
+                    if (pos >= input.size() || !is_whitespace(input[pos])) break;
+                    ++pos;
+                }
+            }
+
+            void write_indent(size_t depth) {
+                if constexpr (Options.indent != 0) {
+                    buffer.append(std::string_view{"\n"});
+                    writers::append_spaces(buffer, depth * Options.indent);
+                }
+            }
+
+            void copy_string() {
+                size_t begin = pos++;
+                while (true) {
+                    for (; pos + swar::word_size <= input.size(); pos += swar::word_size) {
+                        auto word = swar::load(input.data() + pos);
+                        if (auto mask = swar::has_byte(word, '"') | swar::has_byte(word, '\\')) {
+                            pos += swar::first_index(mask);
+                            break;
+                        }
+                    }
+                    while (pos < input.size() && input[pos] != '"' && input[pos] != '\\') {
+                        ++pos;
+                    }
+                    if (pos >= input.size()) {
+                        throw json_reformat_error{"Unterminated string"};
+                    }
+                    if (input[pos] == '"') break;
+                    pos += 2;
+                }
+                ++pos;
+                buffer.append(input.substr(begin, pos - begin));
+            }
+
+            void copy_scalar() {
+                size_t begin = pos;
+                while (pos < input.size() && scalar_chars[static_cast<unsigned char>(input[pos])]) {
+                    ++pos;
+                }
+                if (pos == begin) {
+                    throw json_reformat_error{std::format("Unexpected character at offset {}", pos)};
+                }
+                buffer.append(input.substr(begin, pos - begin));
+            }
+
+        public:
+            json_reformatter(std::string_view input, Buffer &buffer)
+                : input{input}
+                , buffer{buffer} {}
+
+            void operator()() {
+                // What may come next: inside an object keys and values alternate
+                // around ':', so a frame's state follows from closing.back().
+                enum class expect { value, key, colon, separator };
+                expect state = expect::value;
+
+                skip_whitespace();
+                while (pos < input.size()) {
+                    char c = input[pos];
+                    auto unexpected = [&] {
+                        return json_reformat_error{std::format("Unexpected character at offset {}", pos)};
+                    };
+                    switch (c) {
+                    case '{':
+                    case '[': {
+                        if (state != expect::value) throw unexpected();
+                        char close = c == '{' ? '}' : ']';
+                        buffer.append(input.substr(pos++, 1));
+                        skip_whitespace();
+                        if (pos < input.size() && input[pos] == close) {
+                            buffer.append(input.substr(pos++, 1));
+                            state = expect::separator;
+                        } else {
+                            closing.push_back(close);
+                            write_indent(closing.size());
+                            state = close == '}' ? expect::key : expect::value;
+                        }
+                        break;
+                    }
+                    case '}':
+                    case ']':
+                        if (state != expect::separator || closing.empty() || closing.back() != c) throw unexpected();
+                        closing.pop_back();
+                        write_indent(closing.size());
+                        buffer.append(input.substr(pos++, 1));
+                        break;
+                    case ',':
+                        if (state != expect::separator || closing.empty()) throw unexpected();
+                        buffer.append(input.substr(pos++, 1));
+                        if constexpr (Options.indent == 0) {
+                            writers::append_spaces(buffer, Options.comma_space);
+                        } else {
+                            write_indent(closing.size());
+                        }
+                        state = closing.back() == '}' ? expect::key : expect::value;
+                        break;
+                    case ':':
+                        if (state != expect::colon) throw unexpected();
+                        buffer.append(input.substr(pos++, 1));
+                        writers::append_spaces(buffer, Options.colon_space);
+                        state = expect::value;
+                        break;
+                    case '"':
+                        if (state != expect::value && state != expect::key) throw unexpected();
+                        copy_string();
+                        state = state == expect::key ? expect::colon : expect::separator;
+                        break;
+                    default:
+                        if (state != expect::value) throw unexpected();
+                        copy_scalar();
+                        state = expect::separator;
+                    }
+                    skip_whitespace();
+                }
+
+                if (state != expect::separator || !closing.empty()) {
+                    throw json_reformat_error{"Unexpected end of input"};
+                }
+            }
+        };
+
+    }
+
+    // Appends input to buffer laid out as json_writer<Buffer, Options> would have written it.
+    template<writers::json_writer_options Options = writers::json_writer_options{}, writers::output_buffer Buffer>
+    void reformat_json_into(Buffer &buffer, std::string_view input) {
+        detail::json_reformatter<Buffer, Options>{input, buffer}();
+    }
+
+    template<writers::json_writer_options Options = writers::json_writer_options{}>
+    std::string reformat_json(std::string_view input) {
+        std::string buf;
+        buf.reserve(input.size());
+        reformat_json_into<Options>(buf, input);
+        return buf;
+    }
+
+    inline std::string minify_json(std::string_view input) {
+        return reformat_json(input);
+    }
+
+}
+
+#endif
@@ -5,6 +5,8 @@
 #include <stdexcept>
 
 #include "writer.h"
+#include "utf8.h"
+#include "swar.h"
 
 namespace json_context::writers {
     
@@ -12,8 +14,19 @@ namespace json_context::writers {
         int indent = 0;
         int colon_space = 0;
         int comma_space = 0;
+        utf8_mode utf8 = utf8_mode::trust;
     };
 
+    template<output_buffer Buffer>
+    void append_spaces(Buffer &buffer, size_t count) {
+        static constexpr std::string_view spaces = "                                                                ";
+        while (count > spaces.size()) {
+            buffer.append(spaces);
+            count -= spaces.size();
+        }
+        buffer.append(spaces.substr(0, count));
+    }
+
     template<writers::output_buffer Buffer, json_writer_options Options = json_writer_options{}>
     class json_writer {
     private:
@@ -27,6 +40,10 @@ namespace json_context::writers {
             buffer.append(value);
         }
 
+        size_t bytes_written() const requires requires { buffer.size(); } {
+            return buffer.size();
+        }
+
         void write_value(std::nullptr_t) {
             write_direct("null");
         }
@@ -63,13 +80,82 @@ namespace json_context::writers {
 
         template<std::convertible_to<std::string_view> T>
         void write_value(T &&value) {
-            // TODO fix character escapes
             write_direct("\"");
-            write_direct(value);
+            write_escaped(value);
             write_direct("\"");
         }
 
     private:
+        void write_spaces(int count) {
+            append_spaces(buffer, count);
+        }
+
+        static constexpr bool validate_utf8 = Options.utf8 != utf8_mode::trust;
+
+        // Position of the next byte that can't be copied verbatim, scanning a word at a time.
+        static size_t find_special(std::string_view str, size_t i) {
+            for (; i + swar::word_size <= str.size(); i += swar::word_size) {
+                auto word = swar::load(str.data() + i);
+                auto mask = swar::has_byte(word, '"') | swar::has_byte(word, '\\') | swar::has_less(word, 0x20);
+                if constexpr (validate_utf8) {
+                    mask |= swar::has_non_ascii(word);
+                }
+                if (mask) {
+                    return i + swar::first_index(mask);
+                }
+            }
+            for (; i < str.size(); ++i) {
+                unsigned char c = str[i];
+                if (c == '"' || c == '\\' || c < 0x20 || (validate_utf8 && c >= 0x80)) break;
+            }
+            return i;
+        }
+
+        void write_escape(unsigned char c) {
+            switch (c) {
+            case '"':  write_direct("\\\""); break;
+            case '\\': write_direct("\\\\"); break;
+            case '\b': write_direct("\\b"); break;
+            case '\f': write_direct("\\f"); break;
+            case '\n': write_direct("\\n"); break;
+            case '\r': write_direct("\\r"); break;
+            case '\t': write_direct("\\t"); break;
+            default: {
+                static constexpr std::string_view hex_digits = "0123456789abcdef";
+                const char buf[] = { '\\', 'u', '0', '0', hex_digits[c >> 4], hex_digits[c & 0xf] };
+                write_direct(std::string_view(buf, sizeof(buf)));
+            }
+            }
+        }
+
+        // Escapes and, unless Options.utf8 is trust, validates the string in a single pass,
+        // copying the runs between special characters in bulk.
+        void write_escaped(std::string_view str) {
+            size_t run_start = 0;
+            size_t i = 0;
+            while ((i = find_special(str, i)) < str.size()) {
+                unsigned char c = str[i];
+                if (c >= 0x80) {
+                    auto seq = utf8::check_sequence(str.data() + i, str.size() - i);
+                    if (seq.valid) {
+                        i += seq.length;
+                        continue;
+                    }
+                    if constexpr (Options.utf8 == utf8_mode::reject) {
+                        throw json_writer_error{"Invalid UTF-8 sequence in string"};
+                    }
+                    write_direct(str.substr(run_start, i - run_start));
+                    write_direct(utf8::replacement_character);
+                    i += seq.length;
+                } else {
+                    write_direct(str.substr(run_start, i - run_start));
+                    write_escape(c);
+                    ++i;
+                }
+                run_start = i;
+            }
+            write_direct(str.substr(run_start));
+        }
         
         class array_writer {
         private:
@@ -84,9 +170,7 @@ namespace json_context::writers {
                 } else {
                     instance.write_direct(",");
                     if constexpr (Options.comma_space != 0 && Options.indent == 0) {
-                        for (int i = 0; i < Options.comma_space; ++i) {
-                            instance.write_direct(" ");
-                        }
+                        instance.write_spaces(Options.comma_space);
                     }
                 }
             }
@@ -94,9 +178,7 @@ namespace json_context::writers {
             void write_indent() {
                 if constexpr (Options.indent != 0) {
                     instance.write_direct("\n");
-                    for (int i = 0; i < indent * Options.indent; ++i) {
-                        instance.write_direct(" ");
-                    }
+                    instance.write_spaces(indent * Options.indent);
                 }
             }
 
@@ -107,6 +189,10 @@ namespace json_context::writers {
             {
                 instance.write_direct("[");
             }
+
+            size_t bytes_written() const requires requires { instance.bytes_written(); } {
+                return instance.bytes_written();
+            }
         
             void write_value(auto &&value) {
                 write_comma();
@@ -148,9 +234,7 @@ namespace json_context::writers {
                 } else {
                     instance.write_direct(",");
                     if constexpr (Options.comma_space != 0 && Options.indent == 0) {
-                        for (int i = 0; i < Options.comma_space; ++i) {
-                            instance.write_direct(" ");
-                        }
+                        instance.write_spaces(Options.comma_space);
                     }
                 }
             }
@@ -158,9 +242,7 @@ namespace json_context::writers {
             void write_indent() {
                 if constexpr (Options.indent != 0) {
                     instance.write_direct("\n");
-                    for (int i = 0; i < indent * Options.indent; ++i) {
-                        instance.write_direct(" ");
-                    }
+                    instance.write_spaces(indent * Options.indent);
                 }
             }
 
@@ -172,6 +254,10 @@ namespace json_context::writers {
                 instance.write_direct("{");
             }
 
+            size_t bytes_written() const requires requires { instance.bytes_written(); } {
+                return instance.bytes_written();
+            }
+
             void write_key(std::string_view key) {
                 write_comma();
                 write_indent();
@@ -179,9 +265,7 @@ namespace json_context::writers {
                 instance.write_value(key);
                 instance.write_direct(":");
                 if constexpr (Options.colon_space != 0) {
-                    for (int i = 0; i < Options.colon_space; ++i) {
-                        instance.write_direct(" ");
-                    }
+                    instance.write_spaces(Options.colon_space);
                 }
             }
         
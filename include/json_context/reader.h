@@ -1,5 +1,5 @@
-#ifndef __WRITER_H__
-#define __WRITER_H__
+#ifndef __READER_H__
+#define __READER_H__
 
 #include "types.h"
 
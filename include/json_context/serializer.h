@@ -2,6 +2,8 @@
 #define __SERIALIZER_H__
 
 #include "writer.h"
+#include "instrumentation.h"
+#include "table_layout.h"
 
 namespace json_context {
 
@@ -15,11 +17,19 @@ namespace json_context {
 
     template<typename T, writers::writer W, typename Context = no_context> requires serializable<T, Context>
     void serialize(W &writer, const T &value, const Context &context = {}) {
-        serializer<T, Context> obj{};
-        if constexpr (requires { obj(writer, value, context); }) {
-            obj(writer, value, context);
+        auto do_serialize = [&] {
+            serializer<T, Context> obj{};
+            if constexpr (requires { obj(writer, value, context); }) {
+                obj(writer, value, context);
+            } else {
+                obj(writer, value);
+            }
+        };
+        if constexpr (instrumentation::instrumented_context<Context>) {
+            instrumentation::scope scope{context.instrumentation().template serialize_stats<T>(), writer};
+            do_serialize();
         } else {
-            obj(writer, value);
+            do_serialize();
         }
     }
 
@@ -37,17 +47,63 @@ namespace json_context {
         && !std::is_convertible_v<Range, std::string_view>
     )
     struct serializer<Range, Context> {
+        using value_type = std::ranges::range_value_t<Range>;
+
+        static constexpr table_layout layout = get_table_layout<value_type, Context, serializer>();
+
         template<writers::writer W>
-        void operator()(W &writer, const Range &range, const Context &ctx) const {
+        void write_rows(W &writer, const Range &range, const Context &ctx) const {
             auto array = writer.begin_write_array();
 
-            using value_type = std::ranges::range_value_t<Range>;
+            auto header = array.begin_write_array();
+            reflect::for_each<value_type>([&](auto I) {
+                header.write_value(std::string_view{reflect::member_name<I, value_type>()});
+            });
+            header.end();
+
             for (auto &&value : range) {
-                serialize(array, std::forward<decltype(value)>(value), ctx);
+                auto row = array.begin_write_array();
+                reflect::for_each<value_type>([&](auto I) {
+                    serialize(row, reflect::get<I>(value), ctx);
+                });
+                row.end();
             }
 
             array.end();
         }
+
+        template<writers::writer W>
+        void write_columns(W &writer, const Range &range, const Context &ctx) const {
+            auto object = writer.begin_write_object();
+
+            reflect::for_each<value_type>([&](auto I) {
+                object.write_key(reflect::member_name<I, value_type>());
+                auto column = object.begin_write_array();
+                for (auto &&value : range) {
+                    serialize(column, reflect::get<I>(value), ctx);
+                }
+                column.end();
+            });
+
+            object.end();
+        }
+
+        template<writers::writer W>
+        void operator()(W &writer, const Range &range, const Context &ctx) const {
+            if constexpr (layout == table_layout::columns && std::ranges::forward_range<const Range>) {
+                write_columns(writer, range, ctx);
+            } else if constexpr (layout != table_layout::none) {
+                write_rows(writer, range, ctx);
+            } else {
+                auto array = writer.begin_write_array();
+
+                for (auto &&value : range) {
+                    serialize(array, std::forward<decltype(value)>(value), ctx);
+                }
+
+                array.end();
+            }
+        }
     };
     
     template<typename First, typename Second, typename Context>
@@ -81,6 +137,8 @@ namespace json_context {
 
     template<aggregate T, typename Context>
     struct serializer<T, Context> {
+        static constexpr bool builtin_aggregate = true;
+
         template<writers::writer W>
         void operator()(W &writer, const T &value, const Context &ctx) const {
             auto object = writer.begin_write_object();
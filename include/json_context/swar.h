@@ -0,0 +1,60 @@
+#ifndef __SWAR_H__
+#define __SWAR_H__
+
+#include <bit>
+#include <cstdint>
+#include <cstring>
+
+namespace json_context::swar {
+
+    // Byte-parallel tests on 8 bytes at a time held in a 64 bit word.
+    // Each test returns a mask with the high bit set in the matching bytes;
+    // only the lowest flagged byte is guaranteed exact, which is all the scanners need.
+
+    using word = uint64_t;
+
+    static constexpr size_t word_size = sizeof(word);
+
+    static constexpr word ones = ~word{0} / 255;
+    static constexpr word high_bits = ones * 0x80;
+
+    // Loads in little endian order so that the first byte in memory is the least significant.
+    inline word load(const char *data) {
+        word value;
+        std::memcpy(&value, data, word_size);
+        if constexpr (std::endian::native == std::endian::big) {
+            value = std::byteswap(value);
+        }
+        return value;
+    }
+
+    constexpr word has_zero(word value) {
+        return (value - ones) & ~value & high_bits;
+    }
+
+    constexpr word has_byte(word value, unsigned char byte) {
+        return has_zero(value ^ (ones * byte));
+    }
+
+    // requires n <= 128
+    constexpr word has_less(word value, unsigned char n) {
+        return (value - ones * n) & ~value & high_bits;
+    }
+
+    // Exact for every byte, unlike has_zero.
+    constexpr word non_zero(word value) {
+        return (((value & ~high_bits) + ~high_bits) | value) & high_bits;
+    }
+
+    constexpr word has_non_ascii(word value) {
+        return value & high_bits;
+    }
+
+    // Index of the first byte flagged in a mask returned by the functions above.
+    inline size_t first_index(word mask) {
+        return std::countr_zero(mask) / 8;
+    }
+
+}
+
+#endif
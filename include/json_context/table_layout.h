@@ -0,0 +1,51 @@
+#ifndef __TABLE_LAYOUT_H__
+#define __TABLE_LAYOUT_H__
+
+#include "types.h"
+
+namespace json_context {
+
+    // How ranges of aggregates are encoded:
+    //  none:    [{"a":1,"b":"x"},{"a":2,"b":"y"}]
+    //  rows:    [["a","b"],[1,"x"],[2,"y"]]
+    //  columns: {"a":[1,2],"b":["x","y"]}
+    enum class table_layout {
+        none,
+        rows,
+        columns
+    };
+
+    // Specialize to pick a layout for every range of T. Picking table_layout::none
+    // opts T out even when the context asks for a table layout.
+    template<typename T>
+    struct table_encoding {};
+
+    template<typename T>
+    concept has_table_encoding = requires {
+        { table_encoding<T>::value } -> std::convertible_to<table_layout>;
+    };
+
+    // A per type choice wins over the context's, which is read from a static constexpr
+    // member named default_table_layout. The context's choice only applies while T is
+    // handled by the built in aggregate Codec<T, Context>: a table bypasses Codec, so
+    // types with their own serializer or deserializer keep their encoding.
+    template<typename T, typename Context, template<typename, typename> typename Codec>
+    consteval table_layout get_table_layout() {
+        if constexpr (!aggregate<T> || std::ranges::range<T>) {
+            return table_layout::none;
+        } else if constexpr (reflect::size<T>() == 0) {
+            return table_layout::none;
+        } else if constexpr (has_table_encoding<T>) {
+            return table_encoding<T>::value;
+        } else if constexpr (!requires { Codec<T, Context>::builtin_aggregate; }) {
+            return table_layout::none;
+        } else if constexpr (requires { { Context::default_table_layout } -> std::convertible_to<table_layout>; }) {
+            return Context::default_table_layout;
+        } else {
+            return table_layout::none;
+        }
+    }
+
+}
+
+#endif
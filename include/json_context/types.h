@@ -10,6 +10,7 @@
 #include <reflect>
 #include <stdexcept>
 #include <format>
+#include <expected>
 
 namespace json_context {
 
@@ -25,8 +26,78 @@ namespace json_context {
         using std::runtime_error::runtime_error;
     };
 
+    struct json_reformat_error : std::runtime_error {
+        using std::runtime_error::runtime_error;
+    };
+
+    struct compression_error : std::runtime_error {
+        using std::runtime_error::runtime_error;
+    };
+
+    enum class deserialize_errc {
+        expected_integer,
+        expected_float,
+        expected_string,
+        expected_array,
+        expected_array_end,
+        expected_object,
+        expected_object_end,
+        expected_key,
+        unknown_key,
+        duplicate_field,
+        missing_field,
+        column_size_mismatch,
+        invalid_integer,
+        integer_out_of_range,
+        invalid_float,
+        float_out_of_range,
+        invalid_escape,
+        invalid_utf8
+    };
+
+    constexpr std::string_view error_message(deserialize_errc code) {
+        switch (code) {
+        case deserialize_errc::expected_integer:     return "Expected integer";
+        case deserialize_errc::expected_float:       return "Expected float";
+        case deserialize_errc::expected_string:      return "Expected string";
+        case deserialize_errc::expected_array:       return "Expected array";
+        case deserialize_errc::expected_array_end:   return "Expected array end";
+        case deserialize_errc::expected_object:      return "Expected object";
+        case deserialize_errc::expected_object_end:  return "Expected object end";
+        case deserialize_errc::expected_key:         return "Expected key";
+        case deserialize_errc::unknown_key:          return "Cannot find key";
+        case deserialize_errc::duplicate_field:      return "Duplicate field";
+        case deserialize_errc::missing_field:        return "Field missing";
+        case deserialize_errc::column_size_mismatch: return "Column size mismatch";
+        case deserialize_errc::invalid_integer:      return "Invalid integer";
+        case deserialize_errc::integer_out_of_range: return "Integer out of range";
+        case deserialize_errc::invalid_float:        return "Invalid float";
+        case deserialize_errc::float_out_of_range:   return "Float out of range";
+        case deserialize_errc::invalid_escape:       return "Invalid escape sequence";
+        case deserialize_errc::invalid_utf8:         return "Invalid UTF-8 sequence";
+        }
+        return "Unknown error";
+    }
+
+    // Kept trivially copyable so the error path never allocates; message() formats on demand.
+    struct error_info {
+        deserialize_errc code;
+        // Empty when the reader can't tell its position, as with errors thrown by a parser.
+        std::optional<size_t> offset{};
+
+        std::string message() const {
+            if (offset) {
+                return std::format("{} at offset {}", error_message(code), *offset);
+            }
+            return std::string{error_message(code)};
+        }
+    };
+
     struct deserialize_error : std::runtime_error {
         using std::runtime_error::runtime_error;
+
+        explicit deserialize_error(const error_info &info)
+            : std::runtime_error{info.message()} {}
     };
 }
 
@@ -0,0 +1,79 @@
+#ifndef __UTF8_H__
+#define __UTF8_H__
+
+#include <string>
+#include <string_view>
+
+namespace json_context {
+
+    enum class utf8_mode {
+        trust,      // pass bytes through unchecked
+        reject,     // fail on malformed sequences
+        replace     // substitute malformed sequences with U+FFFD
+    };
+
+}
+
+namespace json_context::utf8 {
+
+    static constexpr std::string_view replacement_character = "\xEF\xBF\xBD";
+
+    struct sequence {
+        size_t length;
+        bool valid;
+    };
+
+    // Decodes the multibyte sequence starting at data[0] (which must be >= 0x80).
+    // Invalid sequences report the length of their maximal subpart, as recommended
+    // by the Unicode standard for U+FFFD substitution.
+    inline sequence check_sequence(const char *data, size_t size) {
+        auto byte = [&](size_t i) { return static_cast<unsigned char>(data[i]); };
+        auto in_range = [&](size_t i, unsigned char lo, unsigned char hi) {
+            return i < size && byte(i) >= lo && byte(i) <= hi;
+        };
+
+        unsigned char first = byte(0);
+        unsigned char lo = 0x80, hi = 0xbf;
+        size_t length;
+        if (first >= 0xc2 && first <= 0xdf) {
+            length = 2;
+        } else if (first >= 0xe0 && first <= 0xef) {
+            length = 3;
+            if (first == 0xe0) lo = 0xa0;
+            else if (first == 0xed) hi = 0x9f;
+        } else if (first >= 0xf0 && first <= 0xf4) {
+            length = 4;
+            if (first == 0xf0) lo = 0x90;
+            else if (first == 0xf4) hi = 0x8f;
+        } else {
+            return { 1, false };
+        }
+
+        if (!in_range(1, lo, hi)) return { 1, false };
+        for (size_t i = 2; i < length; ++i) {
+            if (!in_range(i, 0x80, 0xbf)) return { i, false };
+        }
+        return { length, true };
+    }
+
+    inline void append_codepoint(std::string &out, char32_t cp) {
+        if (cp < 0x80) {
+            out.push_back(static_cast<char>(cp));
+        } else if (cp < 0x800) {
+            out.push_back(static_cast<char>(0xc0 | (cp >> 6)));
+            out.push_back(static_cast<char>(0x80 | (cp & 0x3f)));
+        } else if (cp < 0x10000) {
+            out.push_back(static_cast<char>(0xe0 | (cp >> 12)));
+            out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3f)));
+            out.push_back(static_cast<char>(0x80 | (cp & 0x3f)));
+        } else {
+            out.push_back(static_cast<char>(0xf0 | (cp >> 18)));
+            out.push_back(static_cast<char>(0x80 | ((cp >> 12) & 0x3f)));
+            out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3f)));
+            out.push_back(static_cast<char>(0x80 | (cp & 0x3f)));
+        }
+    }
+
+}
+
+#endif
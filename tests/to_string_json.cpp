@@ -2,8 +2,15 @@
 #include <cassert>
 #include <vector>
 #include <map>
+#include <functional>
+#include <cctype>
 
 #include "json_context/json_context.h"
+#include "json_context/json_reformat.h"
+#include "json_context/json_parser.h"
+#include "json_context/deserializer.h"
+#include "json_context/compressed_buffer.h"
+#include "json_context/count_allocations.h"
 
 void test_json_to_string1() {
     struct test_variant {
@@ -69,7 +76,761 @@ void test_json_to_string2() {
     std::cout << json_context::to_string_json(sample_data) << '\n';
 }
 
+void test_json_to_string_instrumented() {
+    struct test_struct {
+        int foo;
+        std::vector<std::string> bar;
+    };
+
+    struct test_context {
+        json_context::instrumentation::registry *registry;
+
+        json_context::instrumentation::registry &instrumentation() const {
+            return *registry;
+        }
+    };
+
+    json_context::instrumentation::registry registry;
+
+    std::vector<test_struct> sample_data{
+        { 1, { "a", "b" } },
+        { 2, { "c" } }
+    };
+
+    std::string result = json_context::to_string_json(sample_data, test_context{&registry});
+
+    auto &vector_stats = registry.serialize_stats<std::vector<test_struct>>();
+    assert(vector_stats.calls == 1);
+    assert(vector_stats.bytes == result.size());
+
+    auto &struct_stats = registry.serialize_stats<test_struct>();
+    assert(struct_stats.calls == 2);
+
+    auto &string_stats = registry.serialize_stats<std::string>();
+    assert(string_stats.calls == 3);
+
+    // count_allocations.h is included above: growing the output while the strings are written allocates
+    assert(vector_stats.allocations > 0);
+    assert(struct_stats.allocations > 0);
+
+    json_context::instrumentation::registry merged;
+    merged.merge(registry);
+    merged.merge(registry);
+    assert(merged.serialize_stats<test_struct>().calls == 4);
+    assert(merged.serialize_stats<std::string>().bytes == 2 * string_stats.bytes);
+
+    std::cout << registry.report() << '\n';
+}
+
+void test_json_to_string_escapes() {
+    std::string sample_data = "quote \" backslash \\ newline \n control \x01 valid \xc3\xa9 invalid \xff";
+
+    std::string trusted = json_context::to_string_json(sample_data);
+    assert(trusted == "\"quote \\\" backslash \\\\ newline \\n control \\u0001 valid \xc3\xa9 invalid \xff\"");
+
+    std::string replaced = json_context::to_string_json<std::string, {
+        .utf8 = json_context::utf8_mode::replace
+    }>(sample_data);
+    assert(replaced == "\"quote \\\" backslash \\\\ newline \\n control \\u0001 valid \xc3\xa9 invalid \xef\xbf\xbd\"");
+
+    bool rejected = false;
+    try {
+        json_context::to_string_json<std::string, {
+            .utf8 = json_context::utf8_mode::reject
+        }>(sample_data);
+    } catch (const json_context::json_writer_error &) {
+        rejected = true;
+    }
+    assert(rejected);
+}
+
+void test_json_parse_string() {
+    json_context::readers::json_parser<> trusted;
+    json_context::readers::json_parser<{ .utf8 = json_context::utf8_mode::replace }> replaced;
+    json_context::readers::json_parser<{ .utf8 = json_context::utf8_mode::reject }> rejected;
+
+    assert(trusted.parse_string(R"(quote \" backslash \\ slash \/ controls \b\f\n\r\t)")
+        == "quote \" backslash \\ slash / controls \b\f\n\r\t");
+    assert(trusted.parse_string(R"(\u0041\u00e9\u20ac)") == "A\xc3\xa9\xe2\x82\xac");
+    assert(trusted.parse_string(R"(\ud83d\ude00)") == "\xf0\x9f\x98\x80");
+    assert(trusted.try_parse_string(R"(\q)").error() == json_context::deserialize_errc::invalid_escape);
+    assert(trusted.try_parse_string(R"(\u12)").error() == json_context::deserialize_errc::invalid_escape);
+    assert(trusted.try_parse_string("\\").error() == json_context::deserialize_errc::invalid_escape);
+
+    // unpaired surrogates
+    assert(replaced.parse_string(R"(\ud83d x)") == "\xef\xbf\xbd x");
+    assert(replaced.parse_string(R"(\ude00)") == "\xef\xbf\xbd");
+    assert(rejected.try_parse_string(R"(\ud83d x)").error() == json_context::deserialize_errc::invalid_utf8);
+    assert(rejected.try_parse_string(R"(\ude00)").error() == json_context::deserialize_errc::invalid_utf8);
+
+    // truncated multibyte sequence
+    assert(replaced.parse_string("valid \xc3\xa9 truncated \xe2\x82") == "valid \xc3\xa9 truncated \xef\xbf\xbd");
+    assert(rejected.try_parse_string("truncated \xe2\x82").error() == json_context::deserialize_errc::invalid_utf8);
+    assert(rejected.parse_string("valid \xc3\xa9") == "valid \xc3\xa9");
+
+    // trust passes every byte through unchanged
+    assert(trusted.parse_string("invalid \xff truncated \xe2\x82") == "invalid \xff truncated \xe2\x82");
+
+    bool thrown = false;
+    try {
+        rejected.parse_string("\xff");
+    } catch (const json_context::deserialize_error &) {
+        thrown = true;
+    }
+    assert(thrown);
+}
+
+// A minimal reader over a JSON document, just enough to drive the deserializers.
+// Only the top level reader has a non const get_parser, which reader_base allows.
+
+template<typename T>
+struct test_optional : std::optional<T> {
+    using std::optional<T>::optional;
+
+    operator bool() const {
+        return this->has_value();
+    }
+};
+
+using test_parser = json_context::readers::json_parser<{ .utf8 = json_context::utf8_mode::reject }>;
+
+struct test_cursor {
+    std::string_view input;
+    size_t pos = 0;
+    test_parser parser{};
+
+    char peek() {
+        while (pos < input.size() && std::isspace(static_cast<unsigned char>(input[pos]))) ++pos;
+        return pos < input.size() ? input[pos] : '\0';
+    }
+
+    bool consume(char c) {
+        if (peek() != c) return false;
+        ++pos;
+        return true;
+    }
+
+    test_optional<std::string_view> read_string() {
+        if (!consume('"')) return std::nullopt;
+        size_t begin = pos;
+        while (pos < input.size() && input[pos] != '"') {
+            pos += input[pos] == '\\' ? 2 : 1;
+        }
+        if (pos >= input.size()) return std::nullopt;
+        return input.substr(begin, pos++ - begin);
+    }
+
+    test_optional<std::string_view> read_number() {
+        char c = peek();
+        if (c != '-' && !std::isdigit(static_cast<unsigned char>(c))) return std::nullopt;
+        size_t begin = pos;
+        while (pos < input.size() && std::string_view{"+-.eE0123456789"}.contains(input[pos])) ++pos;
+        return input.substr(begin, pos - begin);
+    }
+
+    test_optional<std::string_view> read_null() {
+        if (peek() != 'n' || !input.substr(pos).starts_with("null")) return std::nullopt;
+        pos += 4;
+        return input.substr(pos - 4, 4);
+    }
+};
+
+class test_inner_reader {
+private:
+    test_cursor *m_cursor;
+    char m_close;
+    mutable bool m_first = true;
+
+    // values in arrays are separated by commas, in objects read_key takes care of them
+    test_cursor &next() const {
+        if (m_close == ']' && !std::exchange(m_first, false)) {
+            m_cursor->consume(',');
+        }
+        return *m_cursor;
+    }
+
+public:
+    test_inner_reader(test_cursor *cursor, char close)
+        : m_cursor{cursor}, m_close{close} {}
+
+    size_t bytes_read() const { return m_cursor->pos; }
+    const test_parser &get_parser() const { return m_cursor->parser; }
+
+    test_optional<std::string_view> read_string() const { return next().read_string(); }
+    test_optional<std::string_view> read_null() const { return next().read_null(); }
+    test_optional<std::string_view> read_int() const { return next().read_number(); }
+    test_optional<std::string_view> read_float() const { return next().read_number(); }
+
+    test_optional<test_inner_reader> begin_read_array() const {
+        if (!next().consume('[')) return std::nullopt;
+        return test_inner_reader{m_cursor, ']'};
+    }
+
+    test_optional<test_inner_reader> begin_read_object() const {
+        if (!next().consume('{')) return std::nullopt;
+        return test_inner_reader{m_cursor, '}'};
+    }
+
+    test_optional<std::string_view> read_key() const {
+        if (!std::exchange(m_first, false)) {
+            m_cursor->consume(',');
+        }
+        auto key = m_cursor->read_string();
+        if (!key || !m_cursor->consume(':')) return std::nullopt;
+        return key;
+    }
+
+    bool read_end() const {
+        return m_cursor->consume(m_close);
+    }
+};
+
+class test_reader {
+private:
+    test_cursor m_cursor;
+
+public:
+    explicit test_reader(std::string_view input)
+        : m_cursor{input} {}
+
+    size_t bytes_read() const { return m_cursor.pos; }
+    test_parser &get_parser() { return m_cursor.parser; }
+
+    test_optional<std::string_view> read_string() { return m_cursor.read_string(); }
+    test_optional<std::string_view> read_null() { return m_cursor.read_null(); }
+    test_optional<std::string_view> read_int() { return m_cursor.read_number(); }
+    test_optional<std::string_view> read_float() { return m_cursor.read_number(); }
+
+    test_optional<test_inner_reader> begin_read_array() {
+        if (!m_cursor.consume('[')) return std::nullopt;
+        return test_inner_reader{&m_cursor, ']'};
+    }
+
+    test_optional<test_inner_reader> begin_read_object() {
+        if (!m_cursor.consume('{')) return std::nullopt;
+        return test_inner_reader{&m_cursor, '}'};
+    }
+};
+
+template<typename T, typename Context = json_context::no_context>
+json_context::deserialize_result<T> test_deserialize(std::string_view input, const Context &ctx = {}) {
+    test_reader reader{input};
+    return json_context::try_deserialize<T>(reader, ctx);
+}
+
+template<typename T, typename Context = json_context::no_context>
+json_context::error_info test_deserialize_error(std::string_view input, const Context &ctx = {}) {
+    auto result = test_deserialize<T>(input, ctx);
+    assert(!result);
+    return result.error();
+}
+
+void test_deserialize_json() {
+    struct test_point {
+        int x;
+        double y;
+
+        bool operator == (const test_point &) const = default;
+    };
+
+    struct test_struct {
+        int id;
+        std::string name;
+        std::vector<test_point> points;
+        std::pair<int, std::string> pair;
+        std::tuple<int, std::vector<std::string>> tuple;
+        std::variant<int, std::string> variant;
+
+        bool operator == (const test_struct &) const = default;
+    };
+
+    test_struct sample_data{
+        .id {-7},
+        .name {"escaped \" \\ \n \xc3\xa9"},
+        .points { { 1, 0.5 }, { -2, 1e+30 } },
+        .pair { 3, "three" },
+        .tuple { 4, { "a", "b" } },
+        .variant {"text"}
+    };
+
+    static constexpr json_context::writers::json_writer_options pretty_options {
+        .indent = 2,
+        .colon_space = 1
+    };
+
+    auto parsed = test_deserialize<test_struct>(json_context::to_string_json(sample_data));
+    assert(parsed && *parsed == sample_data);
+
+    parsed = test_deserialize<test_struct>(json_context::to_string_json<test_struct, pretty_options>(sample_data));
+    assert(parsed && *parsed == sample_data);
+
+    // members may come in any order
+    auto point = test_deserialize<test_point>(R"({"y":2.5,"x":3})");
+    assert(point && *point == (test_point{ 3, 2.5 }));
+
+    test_reader reader{"[1,2]"};
+    assert(json_context::deserialize<std::vector<int>>(reader) == (std::vector<int>{ 1, 2 }));
+
+    using enum json_context::deserialize_errc;
+    assert(test_deserialize_error<int>(R"("1")").code == expected_integer);
+    assert(test_deserialize_error<double>(R"("1")").code == expected_float);
+    assert(test_deserialize_error<std::string>("1").code == expected_string);
+    assert(test_deserialize_error<std::vector<int>>("{}").code == expected_array);
+    assert((test_deserialize_error<std::pair<int, int>>("[1,2,3]").code == expected_array_end));
+    assert(test_deserialize_error<std::tuple<int>>("[1,2]").code == expected_array_end);
+    assert(test_deserialize_error<test_point>("[]").code == expected_object);
+    assert(test_deserialize_error<std::variant<test_point>>(R"({"test_point":{"x":1,"y":2},"test_point":{}})").code == expected_object_end);
+    assert(test_deserialize_error<test_point>(R"({1:2})").code == expected_key);
+    assert(test_deserialize_error<test_point>(R"({"x":1,"z":2})").code == unknown_key);
+    assert(test_deserialize_error<test_point>(R"({"x":1,"x":2})").code == duplicate_field);
+    assert(test_deserialize_error<test_point>(R"({"x":1})").code == missing_field);
+    assert(test_deserialize_error<int>("1.5").code == invalid_integer);
+    assert(test_deserialize_error<double>("1.5.5").code == invalid_float);
+    for (std::string_view token : { "01", "-01", "1.", "-.5", "1e", "1e+", "-", "1.5e3.5" }) {
+        assert(test_deserialize_error<double>(token).code == invalid_float);
+        assert(test_deserialize_error<int>(token).code == invalid_integer);
+    }
+    for (std::string_view token : { "nan", "NAN", "inf", "-inf", "infinity", ".5", "+1", "0x10" }) {
+        assert(test_parser{}.try_parse_float(token).error() == invalid_float);
+        assert(test_parser{}.try_parse_int(token).error() == invalid_integer);
+    }
+    assert(test_deserialize<double>("-0") == 0.0);
+    assert(test_deserialize<double>("0.5e-3") == 0.5e-3);
+    assert(test_deserialize<double>("-12E+2") == -1200.0);
+    assert(test_deserialize<int>("-0") == 0);
+    assert(test_deserialize_error<std::string>(R"("\q")").code == invalid_escape);
+    assert(test_deserialize_error<std::string>("\"\xff\"").code == invalid_utf8);
+
+    // narrowing from the parsed int64_t
+    assert(test_deserialize<int8_t>("127") == 127);
+    assert(test_deserialize<int8_t>("-128") == -128);
+    assert(test_deserialize_error<int8_t>("128").code == integer_out_of_range);
+    assert(test_deserialize_error<int8_t>("-129").code == integer_out_of_range);
+    assert(test_deserialize_error<uint8_t>("-1").code == integer_out_of_range);
+    assert(test_deserialize_error<uint32_t>("4294967296").code == integer_out_of_range);
+    assert(test_deserialize_error<int64_t>("9223372036854775808").code == integer_out_of_range);
+    assert(test_deserialize<float>("3e38") == 3e38f);
+    assert(test_deserialize_error<float>("1e300").code == float_out_of_range);
+    assert(test_deserialize_error<float>("-1e300").code == float_out_of_range);
+    assert(test_deserialize_error<double>("1e400").code == float_out_of_range);
+
+    // offsets point just past the offending token
+    assert(test_deserialize_error<int>(R"(  "1")").offset == 2);
+    assert(test_deserialize_error<test_point>(R"({"x":1,"z":2})").offset == 11);
+    assert(test_deserialize_error<test_point>(R"({"x":1, "y":"2"})").offset == 12);
+    assert(test_deserialize_error<std::vector<int>>("[1,2,x]").offset == 5);
+
+    auto info = test_deserialize_error<test_point>(R"({"x":1})");
+    assert(info.offset == 7);
+    assert(info.message() == "Field missing at offset 7");
+
+    bool thrown = false;
+    try {
+        test_reader reader{R"({"x":1})"};
+        json_context::deserialize<test_point>(reader);
+    } catch (const json_context::deserialize_error &error) {
+        thrown = true;
+        assert(error.what() == info.message());
+    }
+    assert(thrown);
+
+    // errors thrown by a parser don't know where they happened
+    thrown = false;
+    try {
+        test_parser{}.parse_int("x");
+    } catch (const json_context::deserialize_error &error) {
+        thrown = true;
+        assert(std::string_view{error.what()}.find("offset") == std::string_view::npos);
+    }
+    assert(thrown);
+}
+
+void test_deserialize_into() {
+    struct test_item {
+        int id;
+        std::string name;
+
+        bool operator == (const test_item &) const = default;
+    };
+
+    struct test_struct {
+        std::string text;
+        std::vector<test_item> items;
+        std::variant<test_item, std::string> variant;
+
+        bool operator == (const test_struct &) const = default;
+    };
+
+    test_struct target;
+    auto decode_into = [&](const test_struct &value) {
+        std::string json = json_context::to_string_json(value);
+        test_reader reader{json};
+        json_context::deserialize_into(target, reader);
+        assert(target == value);
+    };
+
+    decode_into(test_struct{
+        .text {"a string long enough to live on the heap"},
+        .items { { 1, "another heap allocated string" }, { 2, "b" }, { 3, "c" } },
+        .variant {test_item{ 4, "d" }}
+    });
+
+    const char *text_data = target.text.data();
+    const char *name_data = target.items[0].name.data();
+    const test_item *items_data = target.items.data();
+    size_t items_capacity = target.items.capacity();
+
+    // shrinks the vector and switches the variant alternative, reusing every buffer
+    decode_into(test_struct{
+        .text {"a different string, but not a longer one"},
+        .items { { 5, "reused heap allocated string" }, { 6, "e" } },
+        .variant {"text"}
+    });
+    assert(target.text.data() == text_data);
+    assert(target.items[0].name.data() == name_data);
+    assert(target.items.data() == items_data);
+    assert(target.items.capacity() == items_capacity);
+    assert(target.variant.index() == 1);
+
+    decode_into(test_struct{
+        .text {"short"},
+        .items { { 7, "f" }, { 8, "g" }, { 9, "h" }, { 10, "i" }, { 11, "j" } },
+        .variant {test_item{ 12, "k" }}
+    });
+    assert(target.items.size() == 5);
+    assert(target.variant.index() == 0);
+
+    // escaped keys are decoded before the lookup
+    test_reader reader{R"({"\u0069d":13,"n\u0061me":"l"})"};
+    test_item item;
+    json_context::deserialize_into(item, reader);
+    assert(item == (test_item{ 13, "l" }));
+    assert(test_deserialize_error<test_item>(R"({"\q":1})").code == json_context::deserialize_errc::invalid_escape);
+    assert(test_deserialize_error<test_item>("{\"\xff\":1}").code == json_context::deserialize_errc::invalid_utf8);
+
+    // long keys are matched without allocating, escaped or not
+    struct test_long_keys {
+        int a_member_name_longer_than_sso;
+        int another_member_name_longer_than_sso;
+    };
+    test_long_keys long_keys;
+    std::string_view long_keys_json = R"({"a_member_name_longer_than_sso":1,"another_member_name_longer_than_s\u0073o":2})";
+    for (int i = 0; i < 2; ++i) {
+        test_reader reader{long_keys_json};
+        size_t allocations = json_context::instrumentation::allocation_count;
+        json_context::deserialize_into(long_keys, reader);
+        if (i != 0) {
+            assert(json_context::instrumentation::allocation_count == allocations);
+        }
+    }
+    assert(long_keys.a_member_name_longer_than_sso == 1 && long_keys.another_member_name_longer_than_sso == 2);
+
+    // parsers without try_parse_key still decode every key
+    struct lowercase_parser {
+        std::string parse_string(std::string_view str) const {
+            std::string result{str};
+            std::ranges::transform(result, result.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+            return result;
+        }
+        int64_t parse_int(std::string_view) const { return 0; }
+        double parse_float(std::string_view) const { return 0; }
+    };
+    struct lowercase_reader {
+        lowercase_parser get_parser() const { return {}; }
+    };
+    static constexpr auto names_map = utils::make_static_map<std::string_view, size_t>({ { "id", 0 }, { "name", 1 } });
+    lowercase_reader lowercase;
+    assert(json_context::detail::find_member_index(lowercase, "NAME", names_map) == 1);
+    assert(json_context::detail::find_member_index(lowercase, "Id", names_map) == 0);
+    assert(json_context::detail::find_member_index(lowercase, "other", names_map).error().code == json_context::deserialize_errc::unknown_key);
+}
+
+void test_json_to_string_buffers() {
+    std::vector<int> sample_data{ 1, 2, 3 };
+
+    std::string buf;
+    json_context::to_json_into(buf, sample_data);
+    assert(buf == "[1,2,3]");
+
+    auto capacity = buf.capacity();
+    json_context::to_json_into(buf, std::vector<int>{ 4 });
+    assert(buf == "[4]");
+    assert(buf.capacity() == capacity);
+
+    json_context::buffer_pool pool;
+    {
+        auto pooled = pool.acquire();
+        json_context::to_json_into(pooled.str(), sample_data);
+        assert(pooled.view() == "[1,2,3]");
+    }
+    assert(pool.free_buffers() == 1);
+
+    auto pooled = json_context::to_json_pooled(sample_data);
+    assert(pooled.view() == "[1,2,3]");
+
+    json_context::buffer_pool small_pool{{
+        .max_buffers = 2,
+        .max_capacity = 1 << 16,
+        .trim_interval = 2
+    }};
+    auto acquire_sized = [&](size_t size) {
+        auto buffer = small_pool.acquire();
+        buffer.str().assign(size, 'x');
+        return buffer;
+    };
+    // max_buffers: a third buffer released at once is freed
+    {
+        auto a = acquire_sized(100), b = acquire_sized(100), c = acquire_sized(100);
+    }
+    assert(small_pool.free_buffers() == 2);
+
+    // max_capacity: an oversized buffer is dropped instead of kept
+    {
+        auto a = small_pool.acquire(), b = small_pool.acquire();
+        a.str().assign(1 << 17, 'x');
+    }
+    assert(small_pool.free_buffers() == 1);
+
+    // a buffer within trim_factor of the recent outputs survives a trim
+    small_pool.trim();
+    {
+        auto a = acquire_sized(10000), b = acquire_sized(3000);
+    }
+    {
+        auto a = acquire_sized(3000), b = acquire_sized(3000);
+    }
+    assert(small_pool.free_capacity() >= 13000);
+
+    // once only small outputs are seen, the grown buffer is shrunk
+    {
+        auto a = acquire_sized(10), b = acquire_sized(10);
+    }
+    assert(small_pool.free_buffers() == 2);
+    assert(small_pool.free_capacity() < 1000);
+}
+
+void test_json_reformat() {
+    struct test_struct {
+        std::string text;
+        std::vector<std::vector<int>> numbers;
+        std::map<std::string, double> values;
+    };
+
+    test_struct sample_data{
+        .text {"a, \"b\": [c] \\"},
+        .numbers { { 1, 2 }, {}, { -3 } },
+        .values { { "x", 1.5 }, { "y", -2e+30 } }
+    };
+
+    static constexpr json_context::writers::json_writer_options pretty_options {
+        .indent = 4,
+        .colon_space = 1
+    };
+
+    static constexpr json_context::writers::json_writer_options spaced_options {
+        .colon_space = 1,
+        .comma_space = 1
+    };
+
+    std::string minified = json_context::to_string_json(sample_data);
+    std::string pretty = json_context::to_string_json<test_struct, pretty_options>(sample_data);
+    std::string spaced = json_context::to_string_json<test_struct, spaced_options>(sample_data);
+
+    assert(json_context::minify_json(pretty) == minified);
+    assert(json_context::minify_json(spaced) == minified);
+    assert(json_context::reformat_json<pretty_options>(minified) == pretty);
+    assert(json_context::reformat_json<pretty_options>(spaced) == pretty);
+    assert(json_context::reformat_json<spaced_options>(pretty) == spaced);
+
+    assert(json_context::minify_json(R"({ "a" : { "b" : [ 1 , { } ] } , "c" : "d" })") == R"({"a":{"b":[1,{}]},"c":"d"})");
+
+    for (std::string_view invalid : {
+        "", "[1, 2", "[1 2]", "[1,]", "[,1]", "{\"a\":1,}", "[1:2]", "1 2",
+        "{\"a\":1:2}", "{\"a\",1}", "{1:2}", "{\"a\"}", "{\"a\":}", "{:1}", "{\"a\" \"b\"}", "[\"a\":1]"
+    }) {
+        bool rejected = false;
+        try {
+            json_context::minify_json(invalid);
+        } catch (const json_context::json_reformat_error &) {
+            rejected = true;
+        }
+        assert(rejected);
+    }
+}
+
+struct rows_context {
+    static constexpr auto default_table_layout = json_context::table_layout::rows;
+};
+
+struct columns_context {
+    static constexpr auto default_table_layout = json_context::table_layout::columns;
+};
+
+struct opted_out_row {
+    int id;
+};
+
+struct custom_row {
+    int id;
+};
+
+template<>
+struct json_context::table_encoding<opted_out_row> : std::integral_constant<json_context::table_layout, json_context::table_layout::none> {};
+
+template<>
+struct json_context::serializer<custom_row, rows_context> {
+    template<json_context::writers::writer W>
+    void operator()(W &writer, const custom_row &value) const {
+        writer.write_value(value.id);
+    }
+};
+
+void test_json_to_string_table() {
+    struct test_row {
+        int id;
+        std::string name;
+
+        bool operator == (const test_row &) const = default;
+    };
+
+    std::vector<test_row> sample_data{
+        { 1, "foo" },
+        { 2, "bar" }
+    };
+
+    std::string rows = json_context::to_string_json(sample_data, rows_context{});
+    assert(rows == R"([["id","name"],[1,"foo"],[2,"bar"]])");
+    assert(test_deserialize<std::vector<test_row>>(rows, rows_context{}) == sample_data);
+
+    std::string columns = json_context::to_string_json(sample_data, columns_context{});
+    assert(columns == R"({"id":[1,2],"name":["foo","bar"]})");
+    assert(test_deserialize<std::vector<test_row>>(columns, columns_context{}) == sample_data);
+
+    // columns don't have to follow the member order
+    assert(test_deserialize<std::vector<test_row>>(R"([["name","id"],["foo",1],["bar",2]])", rows_context{}) == sample_data);
+    assert(test_deserialize<std::vector<test_row>>(R"({"name":["foo","bar"],"id":[1,2]})", columns_context{}) == sample_data);
+
+    std::vector<test_row> empty;
+    assert(json_context::to_string_json(empty, rows_context{}) == R"([["id","name"]])");
+    assert(json_context::to_string_json(empty, columns_context{}) == R"({"id":[],"name":[]})");
+    assert(test_deserialize<std::vector<test_row>>(R"([["id","name"]])", rows_context{}) == empty);
+    assert(test_deserialize<std::vector<test_row>>("[]", rows_context{}) == empty);
+    assert(test_deserialize<std::vector<test_row>>(R"({"id":[],"name":[]})", columns_context{}) == empty);
+
+    using enum json_context::deserialize_errc;
+    assert(test_deserialize_error<std::vector<test_row>>(R"({"id":[1,2],"name":["foo"]})", columns_context{}).code == column_size_mismatch);
+    assert(test_deserialize_error<std::vector<test_row>>(R"({"id":[1,2]})", columns_context{}).code == missing_field);
+    assert(test_deserialize_error<std::vector<test_row>>(R"({"id":[1],"name":["foo"],"id":[2]})", columns_context{}).code == duplicate_field);
+    assert(test_deserialize_error<std::vector<test_row>>(R"([["id"],[1]])", rows_context{}).code == missing_field);
+    assert(test_deserialize_error<std::vector<test_row>>(R"([["id","name","id"],[1,"foo",1]])", rows_context{}).code == duplicate_field);
+    assert(test_deserialize_error<std::vector<test_row>>(R"([["id","name"],[1]])", rows_context{}).code == missing_field);
+    assert(test_deserialize_error<std::vector<test_row>>(R"([["id","name"],[1,"foo",3]])", rows_context{}).code == expected_array_end);
+
+    // an explicit table_encoding of none wins over the context
+    std::vector<opted_out_row> opted_out{ { 1 }, { 2 } };
+    assert(json_context::to_string_json(opted_out, rows_context{}) == R"([{"id":1},{"id":2}])");
+
+    // user serializers are never bypassed by the context's layout
+    std::vector<custom_row> custom{ { 1 }, { 2 } };
+    assert(json_context::to_string_json(custom, rows_context{}) == "[1,2]");
+}
+
+#ifdef JSON_CONTEXT_HAS_ZLIB
+void test_json_to_string_compressed() {
+    std::vector<std::string> sample_data;
+    for (int i = 0; i < 10000; ++i) {
+        sample_data.push_back(std::format("value {}", i));
+    }
+
+    std::string compressed;
+    json_context::compression::deflate_buffer<std::function<void(std::string_view)>, 4096> buffer{
+        [&](std::string_view data) { compressed.append(data); }
+    };
+    json_context::writers::json_writer writer{buffer};
+    json_context::serialize(writer, sample_data);
+    buffer.finish();
+
+    std::string expected = json_context::to_string_json(sample_data);
+    assert(buffer.size() == expected.size());
+    assert(compressed.size() < expected.size());
+
+    std::string_view remaining = compressed;
+    json_context::compression::inflate_source source{[&](std::span<char> data) {
+        size_t count = std::min(data.size(), remaining.size());
+        std::ranges::copy(remaining.substr(0, count), data.begin());
+        remaining.remove_prefix(count);
+        return count;
+    }};
+
+    std::string decompressed;
+    source.read_all(decompressed);
+    assert(decompressed == expected);
+}
+#endif
+
+#ifdef JSON_CONTEXT_HAS_ZSTD
+void test_json_to_string_zstd() {
+    std::vector<std::string> sample_data;
+    for (int i = 0; i < 100000; ++i) {
+        sample_data.push_back(std::format("value {}", i));
+    }
+
+    std::string compressed;
+    json_context::compression::zstd_buffer<std::function<void(std::string_view)>> buffer{
+        [&](std::string_view data) { compressed.append(data); }
+    };
+    json_context::writers::json_writer writer{buffer};
+
+    // a flushed prefix can be decoded before the frame is ended
+    json_context::serialize(writer, std::string_view{"prefix"});
+    buffer.flush();
+    size_t flushed_size = compressed.size();
+    assert(flushed_size != 0);
+
+    json_context::serialize(writer, sample_data);
+    buffer.finish();
+    assert(compressed.size() > flushed_size);
+
+    std::string expected = "\"prefix\"" + json_context::to_string_json(sample_data);
+    assert(buffer.size() == expected.size());
+    assert(compressed.size() < expected.size());
+
+    // small reads make next() resume both on exhausted input and on a full output block
+    std::string_view remaining = compressed;
+    json_context::compression::zstd_source source{[&](std::span<char> data) {
+        size_t count = std::min({ data.size(), remaining.size(), size_t{1000} });
+        std::ranges::copy(remaining.substr(0, count), data.begin());
+        remaining.remove_prefix(count);
+        return count;
+    }};
+
+    std::string decompressed;
+    size_t chunks = 0;
+    for (auto chunk = source.next(); !chunk.empty(); chunk = source.next()) {
+        decompressed.append(chunk);
+        ++chunks;
+    }
+    assert(decompressed == expected);
+    assert(chunks > 1);
+    assert(remaining.empty());
+}
+#endif
+
 int main() {
     test_json_to_string1();
     test_json_to_string2();
+    test_json_to_string_instrumented();
+    test_json_to_string_escapes();
+    test_json_parse_string();
+    test_deserialize_json();
+    test_deserialize_into();
+    test_json_to_string_buffers();
+    test_json_reformat();
+    test_json_to_string_table();
+#ifdef JSON_CONTEXT_HAS_ZLIB
+    test_json_to_string_compressed();
+#endif
+#ifdef JSON_CONTEXT_HAS_ZSTD
+    test_json_to_string_zstd();
+#endif
 }
\ No newline at end of file